@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "limits.h"
+#include "protocol.h"
+#include "grid.h"
+#include "fluid.h"
+#include "arena.h"
+#include "utils.h"
+
+/* Прорыв плотины: бассейн источников на каменной площадке над обрывом,
+   стенку убирают игроки (block_set), вода растекается и падает на
+   ландшафт. Фазы fluid_tick идут до опустевших очередей.
+   "до"    - без бюджета: фаза берёт все созревшие позиции
+   "после" - FLUID_FLOW_LIMIT позиций за фазу
+   Итоговый мир обоих прогонов сверяется (бюджет меняет только темп),
+   у края плотины проверяются уровни. Рядом стоят игроки - изменения
+   уходят им пачками по секциям (conn = NULL, очереди не участвуют). */
+
+ServerState server_state;
+
+#define AREA_CHUNKS 16
+#define FLOOR_Y 100
+#define POOL_WIDTH 16   /* источники при x < POOL_WIDTH, стенка - x = POOL_WIDTH */
+#define CLIFF_X 20      /* площадка обрывается */
+#define VIEWERS 16
+#define MAX_PHASES 100000
+#define NO_BUDGET 0x7FFFFFFF
+
+typedef struct {
+    int phases;
+    double max_ms;
+    double total_ms;
+    uint64_t world_hash;
+} RunResult;
+
+static void set_cell(int32_t x, int32_t y, int32_t z, uint8_t block) {
+    Chunk* chunk = chunk_find(x >> 4, z >> 4);
+    chunk->blocks[x & 15][y][z & 15] = block;
+    fluid_level_set(chunk, x & 15, y, z & 15, 0);
+}
+
+static void build_world() {
+    server_state.loaded_chunks = 0;
+    for (int cx = -1; cx <= AREA_CHUNKS; cx++) {
+        for (int cz = -1; cz <= AREA_CHUNKS; cz++) {
+            chunk_get_or_create(cx, cz);
+        }
+    }
+
+    for (int32_t x = 0; x < AREA_CHUNKS * 16; x++) {
+        for (int32_t z = 0; z < AREA_CHUNKS * 16; z++) {
+            set_cell(x, FLOOR_Y, z, x < CLIFF_X ? BLOCK_STONE : BLOCK_AIR);
+            for (int32_t y = FLOOR_Y + 1; y <= FLOOR_Y + 3; y++) {
+                uint8_t block = x < POOL_WIDTH ? BLOCK_WATER :
+                                x == POOL_WIDTH ? BLOCK_STONE : BLOCK_AIR;
+                set_cell(x, y, z, block);
+            }
+        }
+    }
+}
+
+static void place_viewers() {
+    grid_init();
+    for (int i = 0; i < VIEWERS; i++) {
+        Player* player = &server_state.players[i];
+        player->entity_id = i;
+        player->socket = 1;
+        server_state.hot.ready[i] = true;
+        server_state.hot.x[i] = (double)(i % 4) * 32.0;
+        server_state.hot.z[i] = (double)(i / 4) * 32.0;
+        server_state.hot.y[i] = FLOOR_Y + 1;
+        grid_insert(player);
+    }
+}
+
+/* FNV-1a по блокам и уровням всех чанков */
+static uint64_t world_hash() {
+    uint64_t hash = 1469598103934665603ULL;
+    for (int i = 0; i < server_state.loaded_chunks; i++) {
+        const Chunk* chunk = &server_state.chunks[i];
+        const uint8_t* parts[2] = { &chunk->blocks[0][0][0], chunk->fluid_levels };
+        size_t sizes[2] = { sizeof(chunk->blocks), sizeof(chunk->fluid_levels) };
+        for (int p = 0; p < 2; p++) {
+            for (size_t b = 0; b < sizes[p]; b++) {
+                hash = (hash ^ parts[p][b]) * 1099511628211ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+static RunResult run(int budget) {
+    RunResult result = { 0, 0.0, 0.0, 0 };
+
+    build_world();
+    fluid_init();
+
+    /* Стенку убирают по блоку, как игроки */
+    for (int32_t z = 0; z < AREA_CHUNKS * 16; z++) {
+        for (int32_t y = FLOOR_Y + 1; y <= FLOOR_Y + 3; y++) {
+            block_set(POOL_WIDTH, y, z, BLOCK_AIR);
+        }
+    }
+    arena_reset();
+
+    while (fluid_pending() > 0 && result.phases < MAX_PHASES) {
+        uint64_t start = get_micros();
+        fluid_tick(budget);
+        arena_reset();
+
+        double ms = (double)(get_micros() - start) / 1000.0;
+        if (ms > result.max_ms) result.max_ms = ms;
+        result.total_ms += ms;
+        result.phases++;
+    }
+
+    result.world_hash = world_hash();
+    return result;
+}
+
+/* Край плотины: x = POOL_WIDTH падает с верхних слоёв, дальше уровни 1, 2, 3,
+   за краем площадки - падение вниз */
+static bool verify_levels() {
+    static const uint8_t expected[] = { FLUID_FALLING, 1, 2, 3, 4 };
+    int32_t z = AREA_CHUNKS * 8;
+
+    for (int i = 0; i < 5; i++) {
+        Chunk* chunk = chunk_find((POOL_WIDTH + i) >> 4, z >> 4);
+        int lx = (POOL_WIDTH + i) & 15;
+        if (chunk->blocks[lx][FLOOR_Y + 1][z & 15] != BLOCK_WATER ||
+            fluid_level_get(chunk, lx, FLOOR_Y + 1, z & 15) != expected[i]) {
+            return false;
+        }
+    }
+
+    Chunk* chunk = chunk_find(CLIFF_X >> 4, z >> 4);
+    return chunk->blocks[CLIFF_X & 15][FLOOR_Y][z & 15] == BLOCK_WATER &&
+           fluid_level_get(chunk, CLIFF_X & 15, FLOOR_Y, z & 15) == FLUID_FALLING;
+}
+
+int main() {
+    pthread_rwlock_init(&server_state.players_lock, NULL);
+    pthread_rwlock_init(&server_state.chunks_lock, NULL);
+    server_state.chunks = malloc(sizeof(Chunk) * MAX_CHUNKS_LOADED);
+    if (!server_state.chunks) return 1;
+    place_viewers();
+
+    RunResult before = run(NO_BUDGET);
+    RunResult after = run(FLUID_FLOW_LIMIT);
+
+    if (after.phases >= MAX_PHASES || !verify_levels()) {
+        printf("[BENCH] жидкости: неверные уровни у плотины\n");
+        return 1;
+    }
+    if (before.world_hash != after.world_hash) {
+        printf("[BENCH] жидкости: итог с бюджетом расходится с итогом без него\n");
+        return 1;
+    }
+
+    printf("[BENCH] прорыв плотины, макс. фаза   до: %7.2f мс | после: %7.2f мс | x%.2f\n",
+           before.max_ms, after.max_ms, before.max_ms / after.max_ms);
+    printf("[BENCH] прорыв плотины, всего        до: %7.2f мс за %d фаз | после: %7.2f мс за %d фаз\n",
+           before.total_ms, before.phases, after.total_ms, after.phases);
+    return 0;
+}
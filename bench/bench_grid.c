@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "protocol.h"
+#include "grid.h"
+#include "arena.h"
+#include "utils.h"
+
+/* Рассылка позиций: перебор всех слотов против сетки по чанкам.
+   "до"    - старый player_broadcast_position: MAX_PLAYERS проверок на игрока
+   "после" - те же получатели из ячеек сетки в радиусе видимости
+   Очереди соединений не участвуют (conn = NULL). Число получателей
+   обоих способов сверяется перед замером. */
+
+ServerState server_state;
+
+#define ROUNDS 20
+#define RENDER_RANGE (RENDER_DISTANCE * 16)
+
+/* Шаг на блок по X - пакет движения как при ходьбе */
+static void build_move(BroadcastPacket* move, Player* player) {
+    EntityPose from, to;
+    entity_pose_of(&to, player);
+    from = to;
+    from.x -= 4096;
+    broadcast_entity_movement(move, player->entity_id, &from, &to);
+}
+
+/* Старый путь: перебор всех слотов */
+static int broadcast_legacy(Player* player) {
+    const PlayerHot* hot = &server_state.hot;
+    BroadcastPacket move;
+    build_move(&move, player);
+    int sent = 0;
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player* target = &server_state.players[i];
+        if (target->socket <= 0 || !server_state.hot.ready[i] || target == player) continue;
+
+        double dx = hot->x[player_slot(player)] - hot->x[i];
+        double dz = hot->z[player_slot(player)] - hot->z[i];
+        if (dx * dx + dz * dz > RENDER_RANGE * RENDER_RANGE) continue;
+
+        broadcast_send(&move, target);
+        sent++;
+    }
+
+    broadcast_free(&move);
+    return sent;
+}
+
+typedef struct {
+    Player* source;
+    BroadcastPacket* packet;
+    int count;
+} CountVisit;
+
+static void count_visit(Player* target, void* arg) {
+    CountVisit* visit = arg;
+    const PlayerHot* hot = &server_state.hot;
+    int source = player_slot(visit->source);
+    double dx = hot->x[source] - hot->x[player_slot(target)];
+    double dz = hot->z[source] - hot->z[player_slot(target)];
+    if (target != visit->source && dx * dx + dz * dz <= RENDER_RANGE * RENDER_RANGE) {
+        if (visit->packet) broadcast_send(visit->packet, target);
+        visit->count++;
+    }
+}
+
+/* Новый путь: только ячейки в радиусе */
+static int broadcast_grid(Player* player, bool send) {
+    BroadcastPacket move;
+    CountVisit visit = { player, send ? &move : NULL, 0 };
+
+    if (send) build_move(&move, player);
+    int slot = player_slot(player);
+    grid_query(server_state.hot.x[slot], server_state.hot.z[slot], RENDER_DISTANCE,
+               count_visit, &visit);
+    if (send) broadcast_free(&move);
+    return visit.count;
+}
+
+static void place_players(int area) {
+    uint32_t state = 12345;
+    grid_init();
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player* player = &server_state.players[i];
+        player->entity_id = i;
+        player->socket = 1;
+        server_state.hot.ready[i] = true;
+        server_state.hot.x[i] = (double)(xorshift32(&state) % area) - area / 2;
+        server_state.hot.z[i] = (double)(xorshift32(&state) % area) - area / 2;
+        server_state.hot.y[i] = 64.0;
+        grid_insert(player);
+    }
+}
+
+static bool verify(long* recipients) {
+    long legacy = 0, grid = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        grid += broadcast_grid(&server_state.players[i], false);
+        legacy += broadcast_legacy(&server_state.players[i]);
+        arena_reset();
+    }
+    *recipients = legacy;
+    return legacy == grid;
+}
+
+static double run(bool use_grid) {
+    uint64_t start = get_micros();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (use_grid) {
+                broadcast_grid(&server_state.players[i], true);
+            } else {
+                broadcast_legacy(&server_state.players[i]);
+            }
+        }
+        arena_reset();
+    }
+
+    return (double)(get_micros() - start) / ROUNDS / 1000.0;
+}
+
+static int run_case(const char* name, int area) {
+    place_players(area);
+
+    long recipients = 0;
+    if (!verify(&recipients)) {
+        printf("[BENCH] %s: сетка находит не тех получателей\n", name);
+        return 1;
+    }
+
+    double before = run(false);
+    double after = run(true);
+    printf("[BENCH] %-22s получателей: %7ld | до: %7.2f мс | после: %7.2f мс | x%.2f\n",
+           name, recipients, before, after, before / after);
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+    failed |= run_case("плотно (160x160)", 160);
+    failed |= run_case("город (1024x1024)", 1024);
+    failed |= run_case("разреженно (8192x8192)", 8192);
+    return failed;
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "jobs.h"
+#include "grid.h"
+#include "tracker.h"
+#include "arena.h"
+#include "utils.h"
+
+/* Масштабирование рассылки позиций по пулу заданий: MAX_PLAYERS игроков
+   в одной области, каждый раунд все делают шаг и рассылают движение
+   всем, у кого заспавнены.
+   Очереди соединений не участвуют (conn = NULL) - замеряется сама
+   раздача: проверки дистанции и сборка кадров. */
+
+ServerState server_state;
+
+#define ROUNDS 50
+
+static void broadcast_range(void* arg, int begin, int end) {
+    (void)arg;
+    for (int i = begin; i < end; i++) {
+        player_broadcast_position(&server_state.players[i]);
+    }
+}
+
+static double run(bool parallel) {
+    uint64_t start = get_micros();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        /* Стоящие игроки ничего не шлют - все шагают туда-обратно.
+           Дальние уровни получают движения не каждый тик */
+        server_state.current_tick++;
+        double step = (r & 1) ? 0.25 : -0.25;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            PlayerHot* hot = &server_state.hot;
+            player_set_position(&server_state.players[i], hot->x[i] + step, hot->y[i], hot->z[i],
+                                hot->yaw[i], hot->pitch[i]);
+        }
+
+        if (parallel) {
+            jobs_parallel_for(MAX_PLAYERS, JOB_PLAYER_GRAIN, broadcast_range, NULL);
+        } else {
+            broadcast_range(NULL, 0, MAX_PLAYERS);
+        }
+        arena_reset();
+    }
+
+    return (double)(get_micros() - start) / ROUNDS / 1000.0;
+}
+
+int main() {
+    pthread_rwlock_init(&server_state.players_lock, NULL);
+
+    grid_init();
+
+    uint32_t state = 12345;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player* player = &server_state.players[i];
+        player->entity_id = i;
+        player->socket = 1;
+        server_state.hot.ready[i] = true;
+        server_state.hot.x[i] = (double)(xorshift32(&state) % 160);
+        server_state.hot.z[i] = (double)(xorshift32(&state) % 160);
+        server_state.hot.y[i] = 64.0;
+        grid_insert(player);
+    }
+
+    /* Все соседи заспавнены - рассылка идёт отслеживающим */
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        tracker_update(&server_state.players[i]);
+    }
+    arena_reset();
+
+    if (!jobs_init()) return 1;
+
+    double serial = run(false);
+    double parallel = run(true);
+
+    printf("[BENCH] рассылка %d игроков        1 поток: %7.2f мс | %d потоков: %7.2f мс | x%.2f\n",
+           MAX_PLAYERS, serial, jobs_concurrency(), parallel, serial / parallel);
+
+    jobs_shutdown();
+    return 0;
+}
@@ -0,0 +1,163 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "server.h"
+#include "network.h"
+#include "utils.h"
+
+/* Пропускная способность сброса исходящих очередей: epoll (sendmsg на каждое
+   соединение) против io_uring (пачка SENDMSG одним системным вызовом).
+   Клиенты - TCP loopback, данные вычитывает отдельный поток.
+   io_uring доступен только при сборке make NET_BACKEND=io_uring. */
+
+ServerState server_state;
+
+#define BENCH_CONNECTIONS 128
+#define BENCH_ROUNDS 2000
+#define BENCH_PACKETS_PER_ROUND 16
+#define BENCH_PACKET_SIZE 24  /* типичный пакет движения сущности */
+
+static Connection conns[BENCH_CONNECTIONS];
+static int client_fds[BENCH_CONNECTIONS];
+
+static volatile uint64_t drained_bytes = 0;
+static volatile bool drain_running = true;
+
+static void* drain_thread_func(void* arg) {
+    int epfd = *(int*)arg;
+    struct epoll_event events[64];
+    static uint8_t buf[1 << 16];
+
+    while (drain_running) {
+        int count = epoll_wait(epfd, events, 64, 10);
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            for (;;) {
+                ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+                if (n <= 0) break;
+                __atomic_fetch_add(&drained_bytes, (uint64_t)n, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool setup_connections(int epfd) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+
+    if (listener < 0 ||
+        bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listener, BENCH_CONNECTIONS) < 0 ||
+        getsockname(listener, (struct sockaddr*)&addr, &addr_len) < 0) {
+        perror("[BENCH] listener");
+        return false;
+    }
+
+    for (int i = 0; i < BENCH_CONNECTIONS; i++) {
+        client_fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (client_fds[i] < 0 ||
+            connect(client_fds[i], (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            perror("[BENCH] connect");
+            return false;
+        }
+
+        int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK);
+        if (fd < 0) {
+            perror("[BENCH] accept");
+            return false;
+        }
+
+        Connection* conn = &conns[i];
+        memset(conn, 0, sizeof(Connection));
+        conn->fd = fd;
+        conn->player = &server_state.players[i];
+        pthread_mutex_init(&conn->out.lock, NULL);
+
+        server_state.players[i].socket = fd;
+        server_state.players[i].conn = conn;
+        players_index_add(&server_state.players[i]);
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = client_fds[i] };
+        epoll_ctl(epfd, EPOLL_CTL_ADD, client_fds[i], &ev);
+    }
+
+    close(listener);
+    return true;
+}
+
+/* Байт в секунду: очереди наполняются как за тик, затем один network_flush_all */
+static double run_flush(void) {
+    uint8_t packet[BENCH_PACKET_SIZE];
+    memset(packet, 0xAB, sizeof(packet));
+
+    uint64_t start_drained = __atomic_load_n(&drained_bytes, __ATOMIC_RELAXED);
+    uint64_t total = 0;
+    uint64_t start = get_micros();
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_CONNECTIONS; i++) {
+            for (int p = 0; p < BENCH_PACKETS_PER_ROUND; p++) {
+                network_queue(&conns[i], packet, sizeof(packet));
+            }
+        }
+        total += (uint64_t)BENCH_CONNECTIONS * BENCH_PACKETS_PER_ROUND * sizeof(packet);
+        network_flush_all();
+    }
+
+    /* Досылаем остатки, упёршиеся в буфер сокета */
+    while (__atomic_load_n(&drained_bytes, __ATOMIC_RELAXED) - start_drained < total) {
+        network_flush_all();
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    return (double)total / ((double)elapsed / 1e6);
+}
+
+int main() {
+    memset(&server_state, 0, sizeof(server_state));
+    pthread_rwlock_init(&server_state.players_lock, NULL);
+
+    int epfd = epoll_create1(0);
+    if (epfd < 0 || !setup_connections(epfd)) return 1;
+
+    pthread_t drain_thread;
+    pthread_create(&drain_thread, NULL, drain_thread_func, &epfd);
+
+    network_select_backend(NET_BACKEND_EPOLL);
+    run_flush();  /* прогрев */
+    double epoll_rate = run_flush();
+
+    if (network_select_backend(NET_BACKEND_IO_URING)) {
+        run_flush();
+        double uring_rate = run_flush();
+        printf("[BENCH] %-30s epoll: %9.1f MB/s | io_uring: %9.1f MB/s | x%.2f\n",
+               "network_flush_all", epoll_rate / 1e6, uring_rate / 1e6,
+               uring_rate / epoll_rate);
+    } else {
+        printf("[BENCH] %-30s epoll: %9.1f MB/s | io_uring: недоступен "
+               "(make NET_BACKEND=io_uring)\n", "network_flush_all", epoll_rate / 1e6);
+    }
+
+    drain_running = false;
+    pthread_join(drain_thread, NULL);
+
+    for (int i = 0; i < BENCH_CONNECTIONS; i++) {
+        close(conns[i].fd);
+        close(client_fds[i]);
+    }
+    close(epfd);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "utils.h"
+
+/* Обход онлайн-игроков за тик.
+   обход:  "до" - цикл по MAX_PLAYERS с проверкой socket > 0 && ready,
+           "после" - active_slots[0..active_players)
+   скан:   подсчёт игроков в радиусе точки по плотному списку.
+           "до" - позиция внутри Player (~4 КБ на игрока, как раньше),
+           "после" - горячие массивы server_state.hot
+   Результаты обоих способов сверяются перед замером. */
+
+ServerState server_state;
+
+#define ROUNDS 20000
+#define SCAN_RADIUS 128.0
+
+/* Прежняя раскладка: горячие поля в начале большой структуры игрока */
+typedef struct {
+    double x, y, z;
+    float yaw, pitch;
+    bool on_ground, ready;
+    uint8_t cold[sizeof(Player)];
+} LegacyPlayer;
+
+static LegacyPlayer legacy_players[MAX_PLAYERS];
+
+static double sum_legacy() {
+    double sum = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player* player = &server_state.players[i];
+        if (player->socket > 0 && server_state.hot.ready[i]) sum += server_state.hot.x[i];
+    }
+    return sum;
+}
+
+static double sum_index() {
+    double sum = 0;
+    for (int i = 0; i < server_state.active_players; i++) {
+        int slot = server_state.active_slots[i];
+        if (server_state.hot.ready[slot]) sum += server_state.hot.x[slot];
+    }
+    return sum;
+}
+
+static int scan_legacy(double x, double z) {
+    int count = 0;
+    for (int i = 0; i < server_state.active_players; i++) {
+        LegacyPlayer* player = &legacy_players[server_state.active_slots[i]];
+        double dx = x - player->x;
+        double dz = z - player->z;
+        count += player->ready && dx * dx + dz * dz < SCAN_RADIUS * SCAN_RADIUS;
+    }
+    return count;
+}
+
+static int scan_hot(double x, double z) {
+    const PlayerHot* hot = &server_state.hot;
+    int count = 0;
+    for (int i = 0; i < server_state.active_players; i++) {
+        int slot = server_state.active_slots[i];
+        double dx = x - hot->x[slot];
+        double dz = z - hot->z[slot];
+        count += hot->ready[slot] && dx * dx + dz * dz < SCAN_RADIUS * SCAN_RADIUS;
+    }
+    return count;
+}
+
+/* online случайных слотов, с уходами - чтобы список был перемешан */
+static void place_players(int online) {
+    uint32_t state = 12345;
+    int joined = 0;
+    memset(server_state.players, 0, sizeof(server_state.players));
+    memset(&server_state.hot, 0, sizeof(server_state.hot));
+    memset(legacy_players, 0, sizeof(legacy_players));
+    server_state.active_players = 0;
+
+    while (server_state.active_players < online) {
+        Player* player = &server_state.players[xorshift32(&state) % MAX_PLAYERS];
+        if (player->socket > 0) continue;
+
+        int slot = player_slot(player);
+        player->socket = 1;
+        server_state.hot.ready[slot] = true;
+        server_state.hot.x[slot] = (double)(xorshift32(&state) % 1000);
+        server_state.hot.z[slot] = (double)(xorshift32(&state) % 1000);
+        legacy_players[slot].ready = true;
+        legacy_players[slot].x = server_state.hot.x[slot];
+        legacy_players[slot].z = server_state.hot.z[slot];
+        players_index_add(player);
+
+        /* Каждый четвёртый вход - кто-то случайный уходит */
+        if (++joined % 4 == 0) {
+            Player* leaving = active_player((int)(xorshift32(&state) % server_state.active_players));
+            leaving->socket = 0;
+            server_state.hot.ready[player_slot(leaving)] = false;
+            legacy_players[player_slot(leaving)].ready = false;
+            players_index_remove(leaving);
+        }
+    }
+}
+
+static double run(bool index) {
+    double sum = 0;
+    uint64_t start = get_micros();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        sum += index ? sum_index() : sum_legacy();
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    if (sum == 0) printf("!");
+    return (double)elapsed * 1000.0 / ROUNDS;
+}
+
+/* Скан от каждой точки сетки 0..1000 - как запросы из разных мест мира */
+static double run_scan(bool hot) {
+    long count = 0;
+    uint64_t start = get_micros();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        double x = (double)(r * 37 % 1000);
+        double z = (double)(r * 91 % 1000);
+        count += hot ? scan_hot(x, z) : scan_legacy(x, z);
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    if (count == 0) printf("!");
+    return (double)elapsed * 1000.0 / ROUNDS;
+}
+
+static int run_case(int online) {
+    place_players(online);
+
+    if (sum_legacy() != sum_index()) {
+        printf("[BENCH] %d онлайн: список расходится со слотами\n", online);
+        return 1;
+    }
+
+    double before = run(false);
+    double after = run(true);
+    printf("[BENCH] обход %4d из %d игроков    до: %8.0f нс | после: %8.0f нс | x%.2f\n",
+           online, MAX_PLAYERS, before, after, before / after);
+
+    for (int r = 0; r < 100; r++) {
+        double x = (double)(r * 37 % 1000);
+        if (scan_legacy(x, x) != scan_hot(x, x)) {
+            printf("[BENCH] %d онлайн: скан по горячим массивам расходится\n", online);
+            return 1;
+        }
+    }
+
+    before = run_scan(false);
+    after = run_scan(true);
+    printf("[BENCH] скан  %4d из %d игроков    до: %8.0f нс | после: %8.0f нс | x%.2f\n",
+           online, MAX_PLAYERS, before, after, before / after);
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+    failed |= run_case(40);
+    failed |= run_case(250);
+    failed |= run_case(MAX_PLAYERS);
+    return failed;
+}
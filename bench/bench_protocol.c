@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "protocol.h"
+#include "utils.h"
+#include "chunk_cache.h"
+
+/* Микробенчмарк сборки кадров исходящих пакетов.
+   "до"    - старый send_packet: два buffer_create и две копии данных
+   "после" - packet_finish: заголовок дописывается в резерв перед данными
+   В обоих режимах готовый кадр копируется в приёмник (как в network_queue). */
+
+ServerState server_state;
+
+#define SINK_SIZE (1 << 20)
+
+static uint8_t sink[SINK_SIZE];
+static size_t sink_pos = 0;
+
+static void sink_write(const uint8_t* data, size_t len) {
+    if (sink_pos + len > SINK_SIZE) sink_pos = 0;
+    memcpy(sink + sink_pos, data, len);
+    sink_pos += len;
+}
+
+/* Старый путь кадрирования (как в send_packet до изменения) */
+static size_t frame_legacy(int32_t packet_id, PacketBuffer* payload) {
+    PacketBuffer* packet = buffer_create(payload->position + 16);
+
+    buffer_write_varint(packet, packet_id);
+    memcpy(&packet->data[packet->position], payload->data, payload->position);
+    packet->position += payload->position;
+
+    PacketBuffer* final_packet = buffer_create(packet->position + 8);
+    buffer_write_varint(final_packet, (int32_t)packet->position);
+    memcpy(&final_packet->data[final_packet->position], packet->data, packet->position);
+    final_packet->position += packet->position;
+
+    sink_write(final_packet->data, final_packet->position);
+    size_t len = final_packet->position;
+
+    buffer_free(packet);
+    buffer_free(final_packet);
+    return len;
+}
+
+static size_t frame_inplace(int32_t packet_id, PacketBuffer* payload) {
+    size_t len = packet_finish(payload, packet_id);
+    sink_write(payload->data + payload->head, len);
+    return len;
+}
+
+/* Данные пакетов - те же поля, что пишут packet_send_* */
+static void write_entity_move(PacketBuffer* buf, Player* entity) {
+    const PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(entity);
+    buffer_write_varint(buf, entity->entity_id);
+    buffer_write_short(buf, (int16_t)(hot->x[slot] * 4096));
+    buffer_write_short(buf, (int16_t)(hot->y[slot] * 4096));
+    buffer_write_short(buf, (int16_t)(hot->z[slot] * 4096));
+    buffer_write_byte(buf, hot->on_ground[slot] ? 1 : 0);
+}
+
+static void write_chunk(PacketBuffer* buf, Chunk* chunk) {
+    buffer_write_int(buf, chunk->x);
+    buffer_write_int(buf, chunk->z);
+    buffer_write_varint(buf, 1);
+    buffer_write_varint(buf, 0);
+    buffer_write_varint(buf, 0);
+    buffer_write_varint(buf, sizeof(chunk->blocks));
+    memcpy(&buf->data[buf->position], chunk->blocks, sizeof(chunk->blocks));
+    buf->position += sizeof(chunk->blocks);
+    buffer_write_varint(buf, 0);
+}
+
+static double run_entity_move(bool inplace, Player* entity, int iterations) {
+    uint64_t bytes = 0;
+    uint64_t start = get_micros();
+
+    for (int i = 0; i < iterations; i++) {
+        server_state.hot.x[player_slot(entity)] += 0.01;
+        if (inplace) {
+            PacketBuffer* payload = packet_create(32);
+            write_entity_move(payload, entity);
+            bytes += frame_inplace(0x2A, payload);
+            buffer_free(payload);
+        } else {
+            PacketBuffer* payload = buffer_create(32);
+            write_entity_move(payload, entity);
+            bytes += frame_legacy(0x2A, payload);
+            buffer_free(payload);
+        }
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    return (double)bytes / ((double)elapsed / 1e6);
+}
+
+static double run_chunk_data(bool inplace, Chunk* chunk, int iterations) {
+    uint64_t bytes = 0;
+    uint64_t start = get_micros();
+
+    for (int i = 0; i < iterations; i++) {
+        if (inplace) {
+            PacketBuffer* payload = packet_create(sizeof(chunk->blocks) + 64);
+            write_chunk(payload, chunk);
+            bytes += frame_inplace(0x21, payload);
+            buffer_free(payload);
+        } else {
+            PacketBuffer* payload = buffer_create(sizeof(chunk->blocks) + 64);
+            write_chunk(payload, chunk);
+            bytes += frame_legacy(0x21, payload);
+            buffer_free(payload);
+        }
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    return (double)bytes / ((double)elapsed / 1e6);
+}
+
+/* Кадр Chunk Data со сжатием: собирать заново каждому игроку или взять из кэша */
+static double run_chunk_frame(bool cached, Chunk* chunk, int iterations) {
+    uint64_t bytes = 0;
+    uint64_t start = get_micros();
+
+    for (int i = 0; i < iterations; i++) {
+        Frame* frame = cached ?
+            chunk_cache_lookup(chunk->x, chunk->z, chunk_version(chunk), true) : NULL;
+
+        if (!frame) {
+            PacketBuffer* payload = packet_create(sizeof(chunk->blocks) + 64);
+            write_chunk(payload, chunk);
+            frame = packet_build_frame(payload, 0x21, true);
+            buffer_free(payload);
+            if (cached) {
+                chunk_cache_store(chunk->x, chunk->z, chunk_version(chunk), true, frame);
+            }
+        }
+
+        sink_write(frame->data, frame->len);
+        bytes += sizeof(chunk->blocks);  /* полезные данные до сжатия */
+        frame_release(frame);
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    return (double)bytes / ((double)elapsed / 1e6);
+}
+
+static void report(const char* name, double before, double after) {
+    printf("[BENCH] %-30s до: %9.1f MB/s | после: %9.1f MB/s | x%.2f\n",
+           name, before / 1e6, after / 1e6, after / before);
+}
+
+int main() {
+    Player* entity = &server_state.players[321];
+    entity->entity_id = 321;
+    server_state.hot.y[321] = 64.0;
+
+    Chunk* chunk = chunk_create(0, 0);
+    if (!chunk) return 1;
+    chunk_generate(chunk);
+
+    /* Прогрев */
+    run_entity_move(false, entity, 100000);
+    run_entity_move(true, entity, 100000);
+
+    double move_before = run_entity_move(false, entity, 5000000);
+    double move_after = run_entity_move(true, entity, 5000000);
+    report("packet_send_entity_move_relative", move_before, move_after);
+
+    double chunk_before = run_chunk_data(false, chunk, 4000);
+    double chunk_after = run_chunk_data(true, chunk, 4000);
+    report("packet_send_chunk_data", chunk_before, chunk_after);
+
+    double frame_before = run_chunk_frame(false, chunk, 500);
+    double frame_after = run_chunk_frame(true, chunk, 500);
+    report("chunk_data compressed+cache", frame_before, frame_after);
+
+    chunk_cache_clear();
+    chunk_destroy(chunk);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server.h"
+#include "varint.h"
+#include "utils.h"
+
+/* Микробенчмарк кодеков VarInt на типичных распределениях значений.
+   "до"    - побайтовый цикл (как buffer_write_varint раньше)
+   "после" - varint_encode_batch
+   Перед замером результат пакетного кодека сверяется со старым
+   и читается обратно через varint_decode. */
+
+ServerState server_state;
+
+#define VALUES 4096
+#define ROUNDS 4000
+
+static uint32_t values[VALUES];
+static uint32_t decoded[VALUES];
+static uint8_t encoded[VALUES * VARINT_MAX_BYTES];
+
+/* Старый путь: байт за байтом */
+static size_t encode_legacy(uint8_t* out, const uint32_t* in, size_t count) {
+    uint8_t* start = out;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = in[i];
+        while (v >= 0x80) {
+            *out++ = (uint8_t)((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        *out++ = (uint8_t)v;
+    }
+    return (size_t)(out - start);
+}
+
+/* === РАСПРЕДЕЛЕНИЯ === */
+
+/* Индексы палитры секции: 0..15 */
+static void fill_palette(uint32_t* state) {
+    for (int i = 0; i < VALUES; i++) values[i] = xorshift32(state) & 0x0F;
+}
+
+/* Состояния блоков: в основном воздух/камень/земля, реже редкие блоки */
+static void fill_block_states(uint32_t* state) {
+    for (int i = 0; i < VALUES; i++) {
+        uint32_t r = xorshift32(state);
+        uint32_t bucket = r % 100;
+        if (bucket < 70) values[i] = r % 128;
+        else if (bucket < 97) values[i] = r % 16384;
+        else values[i] = r % 30000;
+    }
+}
+
+/* ID сущностей рядом с игроком: последовательные, 2 байта */
+static void fill_entity_ids(uint32_t* state) {
+    uint32_t base = 1000 + (xorshift32(state) % 1000);
+    for (int i = 0; i < VALUES; i++) values[i] = base + (uint32_t)i;
+}
+
+/* Смесь с отрицательными (5 байт) - худший случай для векторного пути */
+static void fill_mixed(uint32_t* state) {
+    for (int i = 0; i < VALUES; i++) {
+        uint32_t r = xorshift32(state);
+        values[i] = (r % 10 == 0) ? (uint32_t)-(int32_t)(r % 64 + 1) : r % 300;
+    }
+}
+
+static bool verify() {
+    static uint8_t reference[VALUES * VARINT_MAX_BYTES];
+    size_t ref_len = encode_legacy(reference, values, VALUES);
+    size_t len = varint_encode_batch(encoded, values, VALUES);
+    if (len != ref_len || memcmp(reference, encoded, len) != 0) return false;
+
+    size_t pos = 0;
+    for (int i = 0; i < VALUES; i++) {
+        int read = varint_decode(encoded + pos, len - pos, &decoded[i]);
+        if (read <= 0) return false;
+        pos += (size_t)read;
+    }
+    return pos == len && memcmp(decoded, values, sizeof(values)) == 0;
+}
+
+static double run_encode(bool batch) {
+    uint64_t sum = 0;
+    uint64_t start = get_micros();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        sum += batch ? varint_encode_batch(encoded, values, VALUES)
+                     : encode_legacy(encoded, values, VALUES);
+    }
+
+    uint64_t elapsed = get_micros() - start;
+    if (sum == 0) printf("!");
+    return (double)VALUES * ROUNDS / ((double)elapsed / 1e6);
+}
+
+static void report(const char* name, double before, double after) {
+    printf("[BENCH] %-30s до: %9.1f M/s | после: %9.1f M/s | x%.2f\n",
+           name, before / 1e6, after / 1e6, after / before);
+}
+
+static int run_case(const char* name, void (*fill)(uint32_t*)) {
+    uint32_t state = 12345;
+    fill(&state);
+
+    if (!verify()) {
+        printf("[BENCH] %s: пакетный кодек расходится со старым\n", name);
+        return 1;
+    }
+
+    char label[64];
+
+    snprintf(label, sizeof(label), "encode %s", name);
+    double enc_before = run_encode(false);
+    double enc_after = run_encode(true);
+    report(label, enc_before, enc_after);
+    return 0;
+}
+
+/* Старый декодер молча принимал длинные кодировки - новый обязан отказать */
+static int check_rejects() {
+    static const uint8_t overlong[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0, 0, 0, 0 };
+    static const uint8_t overflow[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0, 0, 0, 0, 0 };
+    static const uint8_t minus_one[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0, 0, 0, 0, 0 };
+    uint32_t value = 0;
+
+    for (size_t avail = 5; avail <= 10; avail += 5) {
+        if (varint_decode(overlong, avail, &value) != -1 ||
+            varint_decode(overflow, avail, &value) != -1 ||
+            varint_decode(minus_one, avail, &value) != 5 || value != 0xFFFFFFFFu) {
+            printf("[BENCH] varint_decode принимает повреждённые данные\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main() {
+    if (check_rejects()) return 1;
+
+    int failed = 0;
+    failed |= run_case("palette (0..15)", fill_palette);
+    failed |= run_case("block states", fill_block_states);
+    failed |= run_case("entity ids", fill_entity_ids);
+    failed |= run_case("mixed + negative", fill_mixed);
+    return failed;
+}
@@ -0,0 +1,22 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Допуск подключений до выделения соединения и слота игрока.
+   Корзина токенов на IP (ADMISSION_RATE в секунду, запас ADMISSION_BURST)
+   и общий лимит соединений, ещё не дошедших до логина. Без блокировок:
+   accept идёт параллельно во всех сетевых потоках. */
+
+/* Пустить новое подключение (ip - в сетевом порядке байт).
+   true - занят один слот до логина, его вернёт admission_release */
+bool admission_try_open(uint32_t ip, uint64_t now_ms);
+
+/* Соединение дошло до логина или закрылось */
+void admission_release();
+
+/* Сколько подключений отклонено с прошлого вызова */
+uint32_t admission_take_rejected();
+
+#endif /* ADMISSION_H */
@@ -0,0 +1,28 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Арена пакетов: линейный аллокатор на поток.
+   Память выдаётся сдвигом указателя и целиком возвращается arena_reset()
+   в конце тика. Последний выделенный блок можно вернуть или расширить
+   на месте - типичный цикл create/write/send/free не растит арену. */
+
+/* NULL - блок больше PACKET_ARENA_MAX_ALLOC или арена заполнена */
+void* arena_alloc(size_t size);
+
+/* Принадлежит ли указатель арене текущего потока */
+bool arena_owns(const void* ptr);
+
+/* Расширить последний выделенный блок на месте */
+bool arena_extend(void* ptr, size_t old_size, size_t new_size);
+
+/* Вернуть блок, если он последний (иначе дождётся arena_reset) */
+void arena_free(void* ptr, size_t size);
+
+/* Сбросить арену текущего потока целиком */
+void arena_reset();
+
+#endif /* ARENA_H */
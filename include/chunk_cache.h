@@ -0,0 +1,22 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "frame.h"
+
+/* Кэш готовых кадров Chunk Data по ключу (x, z, версия, формат).
+   Изменение блока поднимает версию чанка - старый кадр просто
+   перестаёт находиться и вытесняется следующей записью в тот же слот.
+   Потокобезопасен: чанки шлют и поток тика, и сетевые потоки. */
+
+/* Кадр с новой ссылкой или NULL */
+Frame* chunk_cache_lookup(int32_t x, int32_t z, uint32_t version, bool compressed);
+
+/* Запомнить кадр (кэш берёт свою ссылку) */
+void chunk_cache_store(int32_t x, int32_t z, uint32_t version, bool compressed, Frame* frame);
+
+/* Отпустить все кадры */
+void chunk_cache_clear();
+
+#endif /* CHUNK_CACHE_H */
@@ -0,0 +1,32 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "frame.h"
+
+/* Сжатие пакетов протокола (zlib, после Set Compression).
+   Кадр: VarInt длины, VarInt Data Length (длина тела до сжатия),
+   тело (ID + данные) в deflate. Крупные тела (данные чанков) сжимает
+   пул из COMPRESSION_THREADS потоков, не занимая поток тика. */
+
+bool compress_init();
+void compress_shutdown();
+
+/* Максимальный размер сжатого кадра для тела body_len байт */
+size_t compress_frame_bound(size_t body_len);
+
+/* Сжать тело в кадр внутри out (не меньше compress_frame_bound).
+   Возвращает начало кадра, длина - в *frame_len; NULL при ошибке */
+uint8_t* compress_frame(const uint8_t* body, size_t body_len,
+                        uint8_t* out, size_t cap, size_t* frame_len);
+
+/* Сжать тело в пуле: тело копируется, кадр станет готов позже
+   (или помечен ошибкой). Без пула сжимает сразу. NULL - нет памяти */
+Frame* compress_frame_async(const uint8_t* body, size_t body_len);
+
+/* Распаковать ровно out_len байт; false - данные повреждены */
+bool compress_inflate(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_len);
+
+#endif /* COMPRESS_H */
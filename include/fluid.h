@@ -0,0 +1,44 @@
+#ifndef FLUID_H
+#define FLUID_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "server.h"
+
+/* Жидкости (вода и лава). Мир не сканируется: изменения ставят свою
+   позицию и соседей в очередь жидкости, фаза берёт не больше бюджета
+   самых старых из созревших - прорыв плотины растекается медленнее,
+   а не удлиняет тик. Позиция в очереди одна (набор ключей), вода
+   созревает через 1 фазу, лава - через FLUID_LAVA_DELAY. Изменения
+   фазы уходят клиентам пачками - один пакет на секцию 16x16x16.
+   Уровень: 0 - источник, 1..7 - растекание, FLUID_FALLING - падает.
+   Только поток тика. */
+
+#define FLUID_FALLING 8
+
+void fluid_init();
+
+/* Блок изменён не жидкостью (игроком): если рядом есть вода или лава,
+   перепроверить позицию и соседей */
+void fluid_block_changed(int32_t x, int32_t y, int32_t z);
+
+/* Фаза жидкостей: обработать не больше budget созревших позиций */
+void fluid_tick(int budget);
+
+/* Позиций в очередях (и созревших, и ждущих) */
+size_t fluid_pending();
+
+/* Уровень жидкости в чанке: полбайта на блок, порядок как у blocks */
+static inline uint8_t fluid_level_get(const Chunk* chunk, int lx, int y, int lz) {
+    int index = (lx * 256 + y) * CHUNK_SIZE + lz;
+    return (chunk->fluid_levels[index >> 1] >> ((index & 1) * 4)) & 0x0F;
+}
+
+static inline void fluid_level_set(Chunk* chunk, int lx, int y, int lz, uint8_t level) {
+    int index = (lx * 256 + y) * CHUNK_SIZE + lz;
+    int shift = (index & 1) * 4;
+    uint8_t* byte = &chunk->fluid_levels[index >> 1];
+    *byte = (uint8_t)((*byte & ~(0x0F << shift)) | ((level & 0x0F) << shift));
+}
+
+#endif /* FLUID_H */
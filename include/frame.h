@@ -0,0 +1,36 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Готовый к отправке кадр пакета со счётчиком ссылок.
+   Очереди соединений держат ссылку, а не копию байт. Кадр может
+   быть ещё не готов (сжимается пулом) - очередь ждёт его на месте,
+   не нарушая порядок пакетов. Кадр, который не удалось собрать,
+   до клиента не доходит: соединение закрывается. */
+
+typedef struct {
+    int refs;
+    int ready;       /* 0 - заполняется, 1 - data/len можно читать, -1 - ошибка */
+    uint8_t* data;   /* начало кадра внутри buf */
+    size_t len;
+    size_t cap;
+    uint8_t buf[];
+} Frame;
+
+/* Кадр с буфером cap байт, одна ссылка у вызывающего */
+Frame* frame_alloc(size_t cap);
+void frame_retain(Frame* frame);
+void frame_release(Frame* frame);
+
+/* Опубликовать содержимое: после этого кадр не меняется */
+void frame_set_ready(Frame* frame);
+bool frame_is_ready(const Frame* frame);
+
+/* Собрать кадр не удалось - отправлять нечего */
+void frame_set_failed(Frame* frame);
+bool frame_is_failed(const Frame* frame);
+
+#endif /* FRAME_H */
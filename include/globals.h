@@ -13,12 +13,50 @@
 #define SERVER_PORT 25565
 #define TICK_RATE 20  /* тики в секунду */
 #define TIME_BETWEEN_TICKS (1000 / TICK_RATE)  /* мс между тиками */
+#define TICK_CATCHUP_SKIP  0  /* отставание забывается, тики идут дальше по сетке */
+#define TICK_CATCHUP_BURST 1  /* пропущенные тики догоняются подряд, без сна */
+#define TICK_CATCHUP_POLICY TICK_CATCHUP_BURST
+#define TICK_CATCHUP_MAX 40  /* тиков долга (2 сек), дальше пропускаем как при SKIP */
+#define TICK_STATS_WINDOW 5000  /* мс, окно подсчёта TPS и MSPT */
+#define PROFILE_TICKS 1  /* замер фаз тика (1 = вкл), отчёт каждые 400 тиков */
+#define PROFILE_SLICE 5000  /* мс на срез гистограмм */
+#define PROFILE_WINDOW_SLICES 12  /* срезов в окне отчёта (минута) */
+#define NET_THREADS 2  /* сетевых потоков, у каждого свой SO_REUSEPORT-сокет */
+#define NET_ACTION_QUEUE_SIZE (256 * 1024)  /* игровые пакеты за тик на сетевой поток */
+#define NET_RECV_BUFFER_SIZE 8192  /* приёмный буфер соединения (макс. размер пакета) */
+#define NET_MAX_EVENTS 256  /* событий epoll за одну итерацию */
+#define NET_POLL_TIMEOUT 100  /* мс ожидания в epoll_wait */
+#define NET_OUT_BLOCK_SIZE 16384  /* блок исходящей очереди соединения */
+#define NET_OUT_BLOCK_POOL 256  /* свободных блоков держим про запас */
+#define NET_FRAME_COPY_MAX 512  /* готовые общие кадры до N байт копируются в очередь */
+#define NET_QUEUE_SOFT_LIMIT (256 * 1024)  /* выше - обновления движений/блоков схлопываются */
+#define NET_QUEUE_HARD_LIMIT (4 * 1024 * 1024)  /* выше - отключаем клиента */
+#define NET_COALESCE_SLOTS 64  /* отложенных обновлений на соединение (степень двойки) */
+#define NET_COALESCE_MAX_PACKET 48  /* крупнее - не схлопываются */
+#define NET_URING_ENTRIES 256  /* размер колец io_uring (make NET_BACKEND=io_uring) */
+#define NET_URING_RECV_BUFFERS 512  /* буферов приёма в кольце (степень двойки) */
+#define NET_URING_RECV_BUFFER_SIZE 4096
+#define ADMISSION_TABLE_SIZE 4096  /* корзин токенов по IP (степень двойки) */
+#define ADMISSION_RATE 2  /* новых подключений в секунду с одного IP */
+#define ADMISSION_BURST 8  /* подключений подряд сверх RATE (не больше 65) */
+#define ADMISSION_MAX_HALF_OPEN 128  /* соединений до логина на весь сервер */
+#define ADMISSION_HANDSHAKE_TIMEOUT 5000  /* мс от accept до Login Start */
+#define COMPRESSION_THRESHOLD 256  /* пакеты от N байт сжимаются (-1 = без сжатия) */
+#define COMPRESSION_ASYNC_MIN 8192  /* от N байт сжимает пул (данные чанков) */
+#define COMPRESSION_THREADS 2  /* потоков сжатия */
+#define JOB_THREADS 3  /* потоков пула заданий сверх потока тика (0 = всё в тике) */
+#define JOB_DEQUE_SIZE 256  /* заданий в очереди потока (степень двойки) */
+#define JOB_MAX_CHUNKS 64  /* кусков одного jobs_parallel_for */
+#define JOB_PLAYER_GRAIN 32  /* игроков на кусок в параллельных фазах */
 
 /* === ОПТИМИЗАЦИЯ ПАМЯТИ === */
 #define CHUNK_SIZE 16
 #define RENDER_DISTANCE 6  /* блоков от игрока */
 #define MAX_CHUNKS_LOADED 512  /* максимум загруженных чанков */
 #define CHUNK_UNLOAD_TIMEOUT 300000  /* мс до выгрузки неиспользуемого чанка */
+#define CHUNK_PACKET_CACHE_SIZE 512  /* готовых пакетов чанков (степень двойки) */
+#define PACKET_ARENA_SIZE (256 * 1024)  /* арена пакетов на поток, сброс каждый тик */
+#define PACKET_ARENA_MAX_ALLOC 16384  /* крупнее (данные чанков) - из кучи */
 
 /* === ОПТИМИЗАЦИЯ МОБОВ === */
 #define ENABLE_MOBS 1  /* 1 = вкл, 0 = выкл */
@@ -34,11 +72,13 @@
 /* === ОПТИМИЗАЦИЯ ЖИДКОСТЕЙ === */
 #define ENABLE_FLUIDS 1
 #define FLUID_UPDATE_TICKS 5  /* обновлять текучесть каждые N тиков */
-#define FLUID_FLOW_LIMIT 500  /* макс потоков в тик */
+#define FLUID_FLOW_LIMIT 500  /* макс обновлений за фазу, остальные ждут следующей */
+#define FLUID_QUEUE_SIZE 65536  /* позиций в очереди каждой жидкости (степень двойки) */
+#define FLUID_LAVA_DELAY 6  /* лава течёт раз в N фаз жидкостей (вода - каждую) */
 
 /* === ОПТИМИЗАЦИЯ ФИЗИКИ === */
 #define ENABLE_PHYSICS 1
-#define ENTITY_UPDATE_RATE 2  /* обновлять сущности каждые N тиков */
+#define ENTITY_UPDATE_RATE 2  /* пересчитывать, кто кого видит, каждые N тиков */
 #define COLLISION_SIMPLE 1  /* упрощённая коллизия */
 
 /* === ХРАНИЛИЩЕ === */
@@ -48,7 +88,7 @@
 
 /* === СОХРАНЕНИЕ МИРА === */
 #define SAVE_INTERVAL 12000  /* мс между сохранениями (60 сек) */
-#define COMPRESSION_LEVEL 1  /* 1 = минимум, 9 = максимум */
+#define COMPRESSION_LEVEL 1  /* 1 = минимум, 9 = максимум (мир и сетевые пакеты) */
 #define ASYNC_SAVE 1  /* сохранять в отдельном потоке */
 
 /* === ОПТИМИЗАЦИЯ ГЕНЕРАЦИИ === */
@@ -56,18 +96,27 @@
 #define CHUNK_GEN_QUEUE_SIZE 64
 
 /* === ТРАНСЛЯЦИЯ ДВИЖЕНИЙ === */
-#define BROADCAST_ALL_MOVEMENT 1  /* транслировать ВСЕ движения */
-#define MOVEMENT_BROADCAST_INTERVAL 1  /* каждый тик */
-#define POSITION_DELTA_THRESHOLD 0.125f  /* блоков на обновление */
+/* Уровни детализации по расстоянию до зрителя: ближе RADIUS (блоков) -
+   движение каждые INTERVAL тиков, дальше MID_RADIUS - FAR_INTERVAL */
+#define ENTITY_LOD_NEAR_RADIUS 16
+#define ENTITY_LOD_NEAR_INTERVAL 1
+#define ENTITY_LOD_MID_RADIUS 48
+#define ENTITY_LOD_MID_INTERVAL 2
+#define ENTITY_LOD_FAR_INTERVAL 4
+#define ENTITY_LOD_HYSTERESIS 4  /* блоков за границей уровня до перехода */
+#define POSITION_DELTA_THRESHOLD 0.125f  /* блоков; меньший сдвиг копится, не рассылается */
 
 /* === ПАРАМЕТРЫ ИГРОКОВ === */
 #define PLAYER_DESPAWN_RADIUS 256  /* блоков */
 #define PLAYER_SPAWN_RADIUS 100
-#define PLAYER_KEEP_ALIVE_INTERVAL 30000  /* мс */
-#define PLAYER_TIMEOUT 60000  /* мс */
+#define GRID_BUCKETS 4096  /* корзин сетки игроков по чанкам (степень двойки) */
+#define PLAYER_KEEP_ALIVE_INTERVAL 30000  /* мс, у каждого игрока свой отсчёт */
+#define PLAYER_KEEP_ALIVE_DEADLINE 15000  /* мс на ответ Keep Alive */
+#define PLAYER_TIMEOUT 60000  /* мс без единого пакета от клиента */
 
 /* === ПРОЧЕЕ === */
 #define MOTD "§6Optimized Server§r\n§7Ultra-lightweight for weak hardware"
+#define STATUS_CACHE_INTERVAL 1000  /* мс, ответ списку серверов пересобирается не чаще */
 #define SPAWN_X 0
 #define SPAWN_Y 64
 #define SPAWN_Z 0
@@ -0,0 +1,30 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+#include "server.h"
+
+/* Пространственная сетка игроков по колонкам чанков (16x16 блоков).
+   Ячейки - в хеш-таблице GRID_BUCKETS корзин, игроки связаны в списки
+   по индексу слота, без выделения памяти. Запрос "кто рядом" обходит
+   только ячейки в радиусе - цена зависит от плотности вокруг, а не от
+   числа игроков на сервере.
+   Меняется в потоке тика (под players_lock на чтение) или под
+   players_lock на запись; читают задания фаз тика. */
+
+void grid_init();
+
+/* Добавить игрока по текущей позиции (повторный вызов - перенос) */
+void grid_insert(Player* player);
+void grid_remove(Player* player);
+
+/* Позиция изменилась: перенос между ячейками только при смене чанка */
+void grid_move(Player* player);
+
+typedef void (*GridVisit)(Player* player, void* arg);
+
+/* Всех игроков в ячейках не дальше radius чанков от колонки (x, z).
+   Точную дистанцию проверяет visit */
+void grid_query(double x, double z, int radius, GridVisit visit, void* arg);
+
+#endif /* GRID_H */
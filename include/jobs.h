@@ -0,0 +1,45 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Пул заданий с перехватом работы (work stealing) для параллельных фаз тика.
+   У каждого потока своя очередь (дек Чейза-Ли): владелец кладёт и берёт
+   с одного конца, свободные потоки перехватывают с другого. Поток тика -
+   участник пула: пока ждёт задания, выполняет их сам. Потоков пула -
+   JOB_THREADS, но не больше числа ядер минус одно; 0 - всё выполняется
+   в вызывающем потоке.
+   Запускать задания - из потока тика или из самих заданий. Пакеты,
+   собранные в задании, живут в арене потока до конца задания. */
+
+typedef void (*JobFunc)(void* arg, int begin, int end);
+
+typedef struct {
+    int pending;  /* незавершённых заданий группы */
+} JobGroup;
+
+/* Память задания - у вызывающего до jobs_wait */
+typedef struct {
+    JobFunc func;
+    void* arg;
+    int begin, end;
+    JobGroup* group;
+} Job;
+
+bool jobs_init();
+void jobs_shutdown();
+
+/* Потоков, выполняющих задания (пул + вызывающий) */
+int jobs_concurrency();
+
+void jobs_spawn(JobGroup* group, Job* job);
+
+/* Дождаться всех заданий группы, выполняя задания самому */
+void jobs_wait(JobGroup* group);
+
+/* func(arg, begin, end) по кускам [0, count) не меньше grain;
+   возврат - когда выполнены все куски */
+void jobs_parallel_for(int count, int grain, JobFunc func, void* arg);
+
+#endif /* JOBS_H */
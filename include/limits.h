@@ -26,6 +26,7 @@
 #define BLOCK_LAPIS_BLOCK     19
 #define BLOCK_DISPENSER       20
 #define BLOCK_SANDSTONE       21
+#define BLOCK_OBSIDIAN        49
 
 /* === ТИПЫ ПРЕДМЕТОВ === */
 #define ITEM_DIAMOND          264
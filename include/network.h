@@ -0,0 +1,117 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "server.h"
+#include "frame.h"
+
+/* Сетевой цикл на epoll (edge-triggered) или io_uring (make NET_BACKEND=io_uring).
+   NET_THREADS потоков, у каждого свой слушающий сокет (SO_REUSEPORT) и свои
+   слоты игроков. Поток собирает пакеты из потока байт; handshake и login
+   обрабатывает сам, игровые действия передаёт потоку тика. */
+
+/* Бэкенд ввода-вывода */
+typedef enum {
+    NET_BACKEND_EPOLL,
+    NET_BACKEND_IO_URING  /* multishot accept/recv, пакетная отправка очередей */
+} NetBackend;
+
+/* Ключи вытесняемых обновлений (network_queue_keyed): более новый пакет
+   с тем же ключом полностью заменяет старый */
+#define NET_KEY_ENTITY_MOVE (1ULL << 56)  /* | entity_id */
+#define NET_KEY_BLOCK       (2ULL << 56)  /* | упакованная позиция */
+
+/* Блок исходящей очереди: свои байты (data) или ссылка на общий кадр.
+   Сегмент кадра выделяется без data */
+typedef struct OutBlock {
+    struct OutBlock* next;
+    size_t len;           /* записано байт (у кадра - 0, пока он не готов) */
+    size_t sent;          /* из них уже отправлено */
+    size_t first_packet;  /* начало первого пакета в блоке (NET_OUT_BLOCK_SIZE - не начинался) */
+    Frame* frame;         /* NULL - данные в data */
+    uint8_t data[NET_OUT_BLOCK_SIZE];
+} OutBlock;
+
+/* Отложенное обновление, ждущее разгрузки очереди */
+typedef struct {
+    uint64_t key;  /* 0 - слот свободен */
+    uint16_t len;
+    uint8_t data[NET_COALESCE_MAX_PACKET];
+} CoalesceSlot;
+
+/* Исходящая очередь: пакеты копируются сюда и уходят одним writev за тик.
+   Выше NET_QUEUE_SOFT_LIMIT обновления с ключом копятся в coalesce (новое
+   заменяет старое), выше NET_QUEUE_HARD_LIMIT клиент отключается */
+typedef struct {
+    pthread_mutex_t lock;
+    OutBlock* head;
+    OutBlock* tail;
+    size_t bytes;     /* ожидает отправки */
+    size_t mem;       /* память блоков очереди (жёсткий лимит) */
+    bool overflow;    /* жёсткий лимит превышен, новые пакеты отбрасываются */
+    bool evicted;     /* отключён за переполнение, ждёт закрытия */
+    int coalesce_count;
+    CoalesceSlot coalesce[NET_COALESCE_SLOTS];
+} OutQueue;
+
+/* Соединение клиента */
+typedef struct Connection {
+    int fd;
+    Player* player;
+    char ip[16];
+    int port;
+
+    /* Приёмный буфер: сюда дописываются байты до получения целого пакета */
+    size_t recv_len;
+    uint8_t recv_buf[NET_RECV_BUFFER_SIZE];
+    bool closing;  /* ошибка протокола, ждём завершения чтения */
+    uint8_t state;  /* состояние протокола до логина (у игрока - protocol_state) */
+    bool half_open;       /* занимает место до логина (admission) */
+    uint64_t opened_at;   /* мс, время accept */
+    uint32_t generation;  /* растёт при каждом занятии слота (под players_lock) */
+
+    OutQueue out;
+} Connection;
+
+bool network_init();
+void network_shutdown();
+/* arg - номер сетевого потока (0..NET_THREADS-1) */
+void* network_thread_func(void* arg);
+
+/* Применить игровые действия, принятые сетевыми потоками (поток тика) */
+void network_process_actions();
+
+/* Выбрать бэкенд. false - io_uring не собран или не поддерживается ядром */
+bool network_select_backend(NetBackend backend);
+NetBackend network_backend();
+
+/* Поставить готовый пакет в исходящую очередь (из любого потока) */
+void network_queue(Connection* conn, const uint8_t* data, size_t len);
+
+/* Поставить обновление состояния, которое вытесняет предыдущее с тем же ключом.
+   Пока очередь ниже мягкого лимита - обычная постановка в очередь */
+void network_queue_keyed(Connection* conn, uint64_t key, const uint8_t* data, size_t len);
+
+/* Поставить относительное обновление (сдвиг от прошлого). false - клиент не
+   успевает или снимок с этим ключом ещё отложен: дельта не поставлена,
+   вместо неё нужен абсолютный снимок через network_queue_keyed */
+bool network_queue_delta(Connection* conn, uint64_t key, const uint8_t* data, size_t len);
+
+/* Поставить в очередь ссылку на кадр (кадр может быть ещё не готов).
+   Мелкие готовые кадры (NET_FRAME_COPY_MAX) копируются */
+void network_queue_frame(Connection* conn, Frame* frame);
+
+/* Отправить накопленное без блокировки; остаток уйдёт в следующем тике */
+void network_flush(Connection* conn);
+
+/* Сбросить очереди всех игроков (конец тика) */
+void network_flush_all();
+
+/* Запросить закрытие соединения (из любого потока).
+   Сокет закрывается сетевым потоком при обработке события. */
+void network_close(Connection* conn);
+
+#endif /* NETWORK_H */
@@ -0,0 +1,53 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <time.h>
+#include "globals.h"
+
+/* Профайлер фаз тика. Длительности копятся в лог-линейных гистограммах
+   (8 корзин на октаву, погрешность до 12.5%) без блокировок: счётчики -
+   атомарные, писать можно из любого потока. Гистограммы нарезаны на
+   срезы по PROFILE_SLICE мс; отчёт - p50/p95/p99/max по последним
+   PROFILE_WINDOW_SLICES срезам (скользящее окно). */
+
+typedef enum {
+    PROF_ACTIONS,   /* действия игроков из сетевых потоков */
+    PROF_TIMERS,    /* keep-alive, таймауты, отложенные задачи */
+    PROF_MOBS,
+    PROF_REDSTONE,
+    PROF_FLUIDS,
+    PROF_ENTITIES,  /* рассылка позиций */
+    PROF_SAVE,
+    PROF_FLUSH,     /* отправка очередей */
+    PROF_TICK,      /* тик целиком, без сна */
+    PROF_PHASE_COUNT
+} ProfPhase;
+
+static inline uint64_t prof_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void prof_record(ProfPhase phase, uint64_t ns);
+
+/* Закрыть фазу, начатую в *start, и начать следующую с этого же момента */
+static inline void prof_lap(ProfPhase phase, uint64_t* start) {
+#if PROFILE_TICKS
+    uint64_t now = prof_now();
+    prof_record(phase, now - *start);
+    *start = now;
+#else
+    (void)phase;
+    (void)start;
+#endif
+}
+
+/* Конец тика: сменить срез, если его время вышло. Поток тика */
+void profiler_tick_end();
+
+/* Напечатать перцентили по окну */
+void profiler_report();
+
+#endif /* PROFILER_H */
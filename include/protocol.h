@@ -3,19 +3,64 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include "server.h"
+#include "frame.h"
 
 /* Minecraft Protocol 772 (1.21.8) */
+#define PROTOCOL_VERSION      772
+#define PROTOCOL_VERSION_NAME "1.21.8"
+
+/* Состояния протокола */
+#define PROTOCOL_STATE_HANDSHAKE 0
+#define PROTOCOL_STATE_STATUS    1
+#define PROTOCOL_STATE_LOGIN     2
+#define PROTOCOL_STATE_PLAY      3
+#define PROTOCOL_STATE_COUNT     4
+
+#define PROTOCOL_MAX_PACKET_ID 0x80  /* размер таблицы обработчиков */
+#define PACKET_HEADROOM 10  /* резерв под VarInt длины, Data Length (сжатие) и ID пакета */
 
 typedef struct {
     uint8_t* data;
     size_t size;
     size_t position;
+    size_t head;  /* начало кадра: данные пакета, после packet_finish - заголовок */
 } PacketBuffer;
 
+/* Входящий кадр: чтение прямо из приёмного буфера, без копий.
+   Границы проверяются по концу кадра; при выходе за них или повреждённом
+   VarInt ставится error, и все следующие чтения возвращают 0 */
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    bool error;
+} PacketReader;
+
+/* Строка внутри кадра: не владеет памятью и не завершается нулём */
+typedef struct {
+    const char* data;
+    size_t len;
+} StringView;
+
 /* === Функции буфера пакетов === */
 PacketBuffer* buffer_create(size_t initial_size);
 void buffer_free(PacketBuffer* buf);
+
+/* Буфер исходящего пакета с резервом под заголовок перед данными */
+PacketBuffer* packet_create(size_t payload_size);
+/* Дописать ID и длину в резерв перед данными (один раз на буфер).
+   Кадр = data[head .. position), возвращает его длину */
+size_t packet_finish(PacketBuffer* buf, int32_t packet_id);
+/* Собрать кадр один раз для многих получателей (формат - со сжатием или без).
+   Кадр крупного пакета может быть ещё не готов - его дожмёт пул сжатия.
+   NULL - нет памяти */
+Frame* packet_build_frame(PacketBuffer* payload, int32_t packet_id, bool compression);
+
+void buffer_write_varint(PacketBuffer* buf, int32_t value);
+void buffer_write_varlong(PacketBuffer* buf, int64_t value);
+void buffer_write_varint_array(PacketBuffer* buf, const int32_t* values, size_t count);
 void buffer_write_byte(PacketBuffer* buf, uint8_t value);
 void buffer_write_short(PacketBuffer* buf, int16_t value);
 void buffer_write_int(PacketBuffer* buf, int32_t value);
@@ -26,33 +71,104 @@ void buffer_write_string(PacketBuffer* buf, const char* str);
 void buffer_write_uuid(PacketBuffer* buf, const uint8_t* uuid);
 void buffer_write_position(PacketBuffer* buf, int32_t x, int32_t y, int32_t z);
 
-uint8_t buffer_read_byte(PacketBuffer* buf);
-int16_t buffer_read_short(PacketBuffer* buf);
-int32_t buffer_read_int(PacketBuffer* buf);
-int64_t buffer_read_long(PacketBuffer* buf);
-float buffer_read_float(PacketBuffer* buf);
-double buffer_read_double(PacketBuffer* buf);
-char* buffer_read_string(PacketBuffer* buf, size_t max_len);
-void buffer_read_uuid(PacketBuffer* buf, uint8_t* uuid);
+/* === Чтение входящего кадра === */
+void reader_init(PacketReader* r, const uint8_t* data, size_t len);
+int32_t reader_varint(PacketReader* r);
+uint8_t reader_byte(PacketReader* r);
+int16_t reader_short(PacketReader* r);
+int32_t reader_int(PacketReader* r);
+int64_t reader_long(PacketReader* r);
+float reader_float(PacketReader* r);
+double reader_double(PacketReader* r);
+/* Строка не длиннее max_len байт; ссылка действительна, пока жив кадр */
+StringView reader_string(PacketReader* r, size_t max_len);
+/* len байт кадра подряд, NULL - не хватает данных */
+const uint8_t* reader_bytes(PacketReader* r, size_t len);
+void reader_uuid(PacketReader* r, uint8_t* uuid);
 
 /* === Обработка пакетов === */
-void protocol_handshake(Player* player, PacketBuffer* buf);
-void protocol_login_start(Player* player, PacketBuffer* buf);
-void protocol_play_position_and_rotation(Player* player, PacketBuffer* buf);
-void protocol_play_block_place(Player* player, PacketBuffer* buf);
-void protocol_play_block_dig(Player* player, PacketBuffer* buf);
+bool protocol_handle_packet(Player* player, PacketReader* frame);
+void protocol_login_start(Player* player, PacketReader* r);
+void protocol_play_keep_alive(Player* player, PacketReader* r);
+void protocol_play_position_and_rotation(Player* player, PacketReader* r);
+void protocol_play_block_place(Player* player, PacketReader* r);
+void protocol_play_block_dig(Player* player, PacketReader* r);
 
 /* === Отправка пакетов === */
+void packet_send_set_compression(Player* player, int32_t threshold);
 void packet_send_login_success(Player* player);
 void packet_send_spawn_position(Player* player);
 void packet_send_player_position_and_look(Player* player);
 void packet_send_chunk_data(Player* player, Chunk* chunk);
 void packet_send_block_change(Player* player, int32_t x, int32_t y, int32_t z, uint8_t block_id);
 void packet_send_player_info(Player* player, Player* target);
-void packet_send_entity_spawn(Player* player, Player* entity);
+/* Положение сущности в единицах протокола: координаты в 1/4096 блока,
+   углы в 1/256 оборота. Движения - разность двух таких положений */
+typedef struct {
+    int64_t x, y, z;
+    uint8_t yaw, pitch;
+    bool on_ground;
+} EntityPose;
+
+void entity_pose_of(EntityPose* pose, const Player* entity);
+bool entity_pose_equal(const EntityPose* a, const EntityPose* b);
+
+/* Спаун в положении pose - от него клиент считает следующие сдвиги */
+void packet_send_entity_spawn(Player* player, Player* entity, const EntityPose* pose);
 void packet_send_entity_destroy(Player* player, int32_t entity_id);
-void packet_send_entity_move_relative(Player* player, Player* entity);
+/* Несколько сущностей одним пакетом */
+void packet_send_entities_destroy(Player* player, const int32_t* entity_ids, int count);
 void packet_send_keep_alive(Player* player, int64_t keep_alive_id);
 void packet_send_disconnect(Player* player, const char* reason);
 
+/* === Соединения без слота игрока === */
+
+/* Handshake и status: слот игрока занимается только под проверенный
+   Login Start. Ответы уходят сразу. false - соединение нужно закрыть */
+bool protocol_handle_connection_packet(struct Connection* conn, PacketReader* frame);
+/* Кадр в состоянии login - целый Login Start (разбирается копия, frame не двигается) */
+bool protocol_login_start_valid(const PacketReader* frame);
+void protocol_handshake(struct Connection* conn, PacketReader* r);
+/* Ответ на старый пинг (0xFE) и закрытие соединения */
+void protocol_send_legacy_status(struct Connection* conn);
+/* Отпустить кэш ответов списку серверов */
+void protocol_status_free();
+
+/* === Рассылка === */
+
+/* Пакет для многих получателей: данные пишутся один раз, кадр собирается
+   один раз на формат (со сжатием и без) и встаёт в очереди по ссылке.
+   broadcast_* заполняет, broadcast_send - на каждого получателя,
+   broadcast_free - в том же потоке.
+   key != 0 - пакет-снимок состояния: медленному клиенту доходит только
+   последний с тем же ключом (network_queue_keyed). С snapshot пакет -
+   дельта: медленному клиенту вместо неё откладывается snapshot */
+typedef struct {
+    int32_t packet_id;
+    uint64_t key;
+    PacketBuffer* payload;
+    Frame* frames[2];  /* [player->compression] */
+    int32_t snapshot_id;
+    PacketBuffer* snapshot;
+    Frame* snapshot_frames[2];
+} BroadcastPacket;
+
+/* Изменение блока в мировых координатах */
+typedef struct {
+    int32_t x, y, z;
+    uint8_t block_id;
+} BlockUpdate;
+
+/* Движение от from к to: Entity Position, Position and Rotation или
+   Rotation, а если сдвиг не помещается в int16 - Entity Teleport */
+void broadcast_entity_movement(BroadcastPacket* bp, int32_t entity_id,
+                               const EntityPose* from, const EntityPose* to);
+void broadcast_entity_teleport(BroadcastPacket* bp, int32_t entity_id, const EntityPose* to);
+void broadcast_entity_destroy(BroadcastPacket* bp, int32_t entity_id);
+void broadcast_block_change(BroadcastPacket* bp, int32_t x, int32_t y, int32_t z, uint8_t block_id);
+/* Пачка изменений одной секции 16x16x16 (Update Section Blocks), count > 0 */
+void broadcast_section_blocks(BroadcastPacket* bp, const BlockUpdate* updates, int count);
+void broadcast_send(BroadcastPacket* bp, Player* target);
+void broadcast_free(BroadcastPacket* bp);
+
 #endif /* PROTOCOL_H */
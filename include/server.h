@@ -7,17 +7,15 @@
 #include <time.h>
 #include "globals.h"
 
-/* Структура для игрока */
+struct Connection;
+
+/* Структура для игрока - холодные данные: имя, сеть, инвентарь, статистика.
+   Позиция и флаги, которые читаются каждый тик, - в PlayerHot по слоту */
 typedef struct {
     int32_t entity_id;
     char username[20];
     uint8_t uuid[16];
     
-    /* Позиция и ориентация */
-    double x, y, z;
-    float yaw, pitch;
-    bool on_ground;
-    
     /* Состояние */
     int32_t health;
     float experience;
@@ -26,11 +24,13 @@ typedef struct {
     /* Сетевые данные */
     int socket;
     uint8_t protocol_state;  /* 0=handshake, 1=status, 2=login, 3=play */
+    bool compression;  /* после Set Compression: кадры с Data Length */
     char ip[16];
     int port;
+    struct Connection* conn;  /* соединение в сетевом потоке */
     
     /* Временные отметки */
-    uint64_t last_keep_alive;
+    uint64_t last_keep_alive;  /* мс, последний ответ на Keep Alive */
     uint64_t join_time;
     
     /* Инвентарь (упрощённо) */
@@ -43,49 +43,86 @@ typedef struct {
     
     /* Флаги */
     bool spawn_position_sent;
-    bool ready;
     
 } Player;
 
+/* Горячие данные игроков, массив на поле (индекс - слот). Обходы видимости
+   и рассылка движения читают только их: x и z всех слотов - 16 КБ подряд,
+   скан дистанций идёт по плотным кэш-линиям, а не по ~4 КБ Player на слот */
+typedef struct {
+    double x[MAX_PLAYERS];
+    double y[MAX_PLAYERS];
+    double z[MAX_PLAYERS];
+    float yaw[MAX_PLAYERS];
+    float pitch[MAX_PLAYERS];
+    bool on_ground[MAX_PLAYERS];
+    bool ready[MAX_PLAYERS];  /* в мире: вход проведён потоком тика, слот не освобождён */
+} PlayerHot;
+
 /* Структура для чанка */
 typedef struct {
     int32_t x, z;  /* координаты чанка */
     uint8_t blocks[CHUNK_SIZE][256][CHUNK_SIZE];  /* [x][y][z] блоки */
     uint32_t last_accessed;
+    uint32_t version;  /* растёт при любом изменении блоков (ключ кэша пакетов) */
     bool modified;
     uint8_t light_data[CHUNK_SIZE * CHUNK_SIZE * 256 / 2];  /* упрощённо */
+    uint8_t fluid_levels[CHUNK_SIZE * CHUNK_SIZE * 256 / 2];  /* по полбайта, 0 - источник */
 } Chunk;
 
 /* Глобальное состояние сервера */
 typedef struct {
     bool running;
-    int server_socket;
     uint32_t current_tick;
     uint64_t server_time;
     
-    /* Игроки */
+    /* Игроки. Слот (= entity_id) закреплён за игроком до отключения.
+       Занятые слоты - плотным списком active_slots[0..active_players):
+       обход стоит O(онлайн), а не MAX_PLAYERS. Меняется под players_lock
+       на запись, порядок не сохраняется (удаление - перестановкой) */
     Player players[MAX_PLAYERS];
     int active_players;
+    int active_slots[MAX_PLAYERS];
+    int active_index[MAX_PLAYERS];  /* позиция слота в active_slots */
+    PlayerHot hot;
     pthread_rwlock_t players_lock;
     
     /* Чанки */
     Chunk* chunks;
     int loaded_chunks;
-    pthread_rwlock_t chunks_lock;
+    pthread_rwlock_t chunks_lock;  /* блоки и уровни жидкостей пишутся под записью */
     
     /* Потоки */
     pthread_t tick_thread;
     pthread_t save_thread;
-    pthread_t network_thread;
+    pthread_t network_threads[NET_THREADS];
     
-    /* Статистика */
+    /* Статистика тиков (планировщик, окно TICK_STATS_WINDOW) */
     uint64_t total_ticks;
-    uint32_t ticks_with_lag;
+    float tps;
+    float mspt;             /* средняя длительность тика, мс */
+    float mspt_max;
+    uint64_t ticks_overrun;  /* тиков дольше TIME_BETWEEN_TICKS, всего */
+    uint64_t ticks_skipped;  /* выброшено при отставании, всего */
     
 } ServerState;
 
 extern ServerState server_state;
 
+/* Слот игрока (= entity_id) - индекс в server_state.hot */
+static inline int player_slot(const Player* player) {
+    return (int)(player - server_state.players);
+}
+
+static inline bool player_ready(const Player* player) {
+    return server_state.hot.ready[player_slot(player)];
+}
+
+/* i-й занятый слот, i < active_players. Под players_lock */
+static inline Player* active_player(int i) {
+    return &server_state.players[server_state.active_slots[i]];
+}
+
 /* Функции сервера */
 bool server_init();
 void server_shutdown();
@@ -98,14 +135,28 @@ void player_destroy(Player* player);
 void player_broadcast_position(Player* player);
 void player_send_chunk(Player* player, int32_t chunk_x, int32_t chunk_z);
 void player_set_position(Player* player, double x, double y, double z, float yaw, float pitch);
+void player_hot_reset(Player* player);
+void remove_player(Player* player);
+
+/* Плотный список занятых слотов (под players_lock на запись) */
+void players_index_add(Player* player);
+void players_index_remove(Player* player);
+
+/* Keep-alive и таймаут игрока (поток тика, колесо таймеров) */
+void player_session_start(Player* player);
+void player_session_touch(Player* player);
+void player_keep_alive_response(Player* player, int64_t keep_alive_id);
 
 /* Функции чанков */
 Chunk* chunk_create(int32_t x, int32_t z);
 void chunk_destroy(Chunk* chunk);
 Chunk* chunk_get_or_create(int32_t x, int32_t z);
+Chunk* chunk_find(int32_t x, int32_t z);  /* без создания, под chunks_lock */
+void chunk_mark_modified(Chunk* chunk);
 void chunk_generate(Chunk* chunk);
 void chunk_save(Chunk* chunk);
 void chunk_load(Chunk* chunk);
+uint32_t chunk_version(const Chunk* chunk);
 
 /* Функции блоков */
 uint8_t block_get(int32_t x, int32_t y, int32_t z);
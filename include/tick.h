@@ -0,0 +1,23 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <stdint.h>
+#include "globals.h"
+
+/* Планировщик игрового цикла на CLOCK_MONOTONIC. Каждый тик начинается
+   в абсолютный дедлайн (clock_nanosleep с TIMER_ABSTIME), поэтому время
+   сна не накапливает погрешность, а перевод системных часов не влияет.
+   При отставании - политика TICK_CATCHUP_POLICY (см. globals.h).
+   Статистику (TPS, MSPT) пишет в server_state раз в TICK_STATS_WINDOW.
+   Только поток тика. */
+
+void tick_scheduler_init();
+
+/* Начало тика (время для MSPT) */
+void tick_begin();
+
+/* Конец тика: учесть длительность и дождаться дедлайна следующего.
+   При BURST-догонянии возвращается сразу */
+void tick_end();
+
+#endif /* TICK_H */
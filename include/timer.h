@@ -0,0 +1,54 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "globals.h"
+
+/* Иерархическое колесо таймеров на часах тиков.
+   TIMER_LEVELS уровней по TIMER_SLOTS слотов: уровень 0 - ближайшие
+   64 тика, каждый следующий в 64 раза грубее; при обороте младшего
+   уровня слот старшего раскладывается вниз. Постановка и отмена - O(1),
+   таймеры встраиваются в структуру владельца и памяти не выделяют.
+   Только поток тика: колесо без блокировок. */
+
+#define TIMER_BITS   6
+#define TIMER_SLOTS  (1 << TIMER_BITS)
+#define TIMER_LEVELS 4
+#define TIMER_MAX_DELAY ((1ULL << (TIMER_BITS * TIMER_LEVELS)) - 1)  /* ~9.7 суток */
+
+/* Миллисекунды в тики (с округлением вверх) */
+#define TIMER_MS(ms) (((ms) + TIME_BETWEEN_TICKS - 1) / TIME_BETWEEN_TICKS)
+
+typedef void (*TimerCallback)(void* arg);
+
+typedef struct Timer {
+    struct Timer* next;
+    struct Timer** pprev;  /* NULL - не запланирован */
+    uint64_t expires;      /* тик срабатывания */
+    TimerCallback callback;
+    void* arg;
+} Timer;
+
+/* Колесо начинает отсчёт с тика now */
+void timer_wheel_init(uint64_t now);
+
+void timer_init(Timer* timer, TimerCallback callback, void* arg);
+
+/* Сработать через delay тиков (минимум 1, больше TIMER_MAX_DELAY - обрезается).
+   Уже запланированный таймер переносится */
+void timer_schedule(Timer* timer, uint64_t delay);
+void timer_cancel(Timer* timer);
+
+static inline bool timer_pending(const Timer* timer) {
+    return timer->pprev != NULL;
+}
+
+/* Последний обработанный тик */
+uint64_t timer_now();
+
+/* Выполнить всё, что истекло к тику now. Обработчик может
+   перепланировать себя и ставить/отменять другие таймеры */
+void timer_advance(uint64_t now);
+
+#endif /* TIMER_H */
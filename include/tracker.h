@@ -0,0 +1,52 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdbool.h>
+#include "server.h"
+#include "protocol.h"
+
+/* Какие игроки заспавнены у каждого клиента (отслеживаемые сущности).
+   У зрителя - битовая строка по слотам на каждый уровень детализации.
+   Раз в ENTITY_UPDATE_RATE тиков tracker_update сравнивает их с
+   окрестностью: вошедшие ближе PLAYER_SPAWN_RADIUS получают Spawn,
+   ушедшие дальше PLAYER_DESPAWN_RADIUS - один общий Destroy Entities.
+   Между радиусами ничего не меняется, поэтому игрок на границе не мигает.
+   Уровень (ENTITY_LOD_*) задаёт, как часто зритель получает движения
+   сущности: ближние - каждый тик, дальние - реже. У каждой сущности на
+   каждом уровне своё положение, последним отправленное зрителям этого
+   уровня: спаун идёт в нём же, поэтому одна дельта годится всем, а при
+   смене уровня зритель получает телепорт в положение нового.
+   Строку зрителя меняет только его задание в фазе сущностей (под
+   players_lock на чтение) или удаление игрока под players_lock на запись. */
+
+#define ENTITY_LOD_TIERS 3
+
+/* Новое соединение в слоте: у него ещё никто не заспавнен, а его
+   отправленные положения - текущее. Поток тика */
+void tracker_reset(Player* viewer);
+
+/* Слот освобождён: забыть всех, кто был заспавнен у viewer, чтобы
+   следующий клиент в слоте не унаследовал их. Под players_lock на запись */
+void tracker_clear(Player* viewer);
+
+/* Спаун вошедших, удаление ушедших, смена уровней. Задание фазы сущностей */
+void tracker_update(Player* viewer);
+
+/* Уровень entity у viewer или -1, если не заспавнен */
+int tracker_tier(const Player* viewer, const Player* entity);
+
+/* Забыть entity у viewer. true - был заспавнен (клиенту нужен Destroy) */
+bool tracker_untrack(Player* viewer, const Player* entity);
+
+/* Пора ли рассылать движения entity уровню tier в этом тике.
+   Сущности сдвинуты по фазе - нагрузка дальних уровней ровная по тикам */
+bool tracker_tier_due(const Player* entity, int tier, uint32_t tick);
+
+/* Радиус в ячейках сетки, где могут быть зрители уровня: граница с
+   гистерезисом и ячейка запаса на движение между пересчётами */
+int tracker_tier_cells(int tier);
+
+/* Положение entity, известное зрителям уровня. Меняет рассылка движений entity */
+EntityPose* tracker_sent_pose(const Player* entity, int tier);
+
+#endif /* TRACKER_H */
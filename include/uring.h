@@ -0,0 +1,73 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <linux/io_uring.h>
+
+/* Минимальная обёртка над io_uring (без liburing): кольца SQ/CQ
+   и кольцо буферов для multishot recv. Кольцо не потокобезопасно -
+   им пользуется один поток. */
+
+typedef struct {
+    int fd;
+
+    /* Очередь отправки */
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned sq_local_tail;  /* заполнено, но ещё не передано ядру */
+    unsigned sq_entries;
+
+    /* Очередь завершений */
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* sq_ring_ptr;
+    size_t sq_ring_size;
+    void* cq_ring_ptr;
+    size_t cq_ring_size;
+    size_t sqes_size;
+} Uring;
+
+/* Кольцо буферов, из которого ядро само выбирает буфер под recv */
+typedef struct {
+    struct io_uring_buf_ring* ring;
+    size_t ring_size;
+    uint8_t* data;
+    unsigned entries;
+    unsigned buf_size;
+    uint16_t group_id;
+} UringBufRing;
+
+/* false - ядро не поддерживает io_uring или нужные возможности */
+bool uring_init(Uring* ring, unsigned entries);
+void uring_exit(Uring* ring);
+
+/* Поддерживает ли ядро операцию IORING_OP_* */
+bool uring_probe_op(Uring* ring, int op);
+
+/* Следующий свободный SQE (обнулённый) или NULL, если очередь полна */
+struct io_uring_sqe* uring_get_sqe(Uring* ring);
+
+/* Передать подготовленные SQE и дождаться wait_nr завершений.
+   timeout_ms < 0 - ждать без ограничения. Возвращает -errno при ошибке */
+int uring_submit_and_wait(Uring* ring, unsigned wait_nr, int timeout_ms);
+
+/* Очередное завершение или NULL; после обработки - uring_cqe_seen */
+struct io_uring_cqe* uring_peek_cqe(Uring* ring);
+void uring_cqe_seen(Uring* ring);
+
+bool uring_buf_ring_init(Uring* ring, UringBufRing* br, uint16_t group_id,
+                         unsigned entries, unsigned buf_size);
+void uring_buf_ring_free(Uring* ring, UringBufRing* br);
+uint8_t* uring_buf_ring_get(UringBufRing* br, uint16_t bid);
+/* Вернуть буфер ядру после обработки данных */
+void uring_buf_ring_recycle(UringBufRing* br, uint16_t bid);
+
+#endif /* URING_H */
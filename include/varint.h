@@ -0,0 +1,33 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* VarInt/VarLong протокола: 7 бит на байт, старший бит - продолжение.
+   Одиночные значения кодируются без цикла по байтам (размер через clz,
+   декодирование словом с поиском последнего байта через ctz). Пакетное
+   кодирование массивов (палитры, списки ID) обрабатывает по 8 (AVX2)
+   или 4 (SSE2) значения за шаг, если все они занимают 1-2 байта,
+   иначе - скалярно; после нескольких таких блоков подряд остаток
+   массива идёт без SIMD. Без SSE2 - только скалярный путь. */
+
+#define VARINT_MAX_BYTES  5
+#define VARLONG_MAX_BYTES 10
+
+int varint_size(uint32_t value);
+int varlong_size(uint64_t value);
+
+/* Записать значение, вернуть длину (в out не меньше *_MAX_BYTES байт) */
+int varint_encode(uint8_t* out, uint32_t value);
+int varlong_encode(uint8_t* out, uint64_t value);
+
+/* Прочитать значение из in[0..avail). Возвращает длину,
+   0 - данных не хватает, -1 - длиннее 5 байт или лишние старшие биты */
+int varint_decode(const uint8_t* in, size_t avail, uint32_t* out);
+
+/* Записать count значений подряд (в out не меньше count * VARINT_MAX_BYTES байт).
+   Возвращает число записанных байт */
+size_t varint_encode_batch(uint8_t* out, const uint32_t* values, size_t count);
+
+#endif /* VARINT_H */
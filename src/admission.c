@@ -0,0 +1,72 @@
+#include "globals.h"
+#include "admission.h"
+
+/* Токены хранятся в тысячных долях */
+#define TOKEN_UNIT 1000
+#define TOKENS_FULL (ADMISSION_BURST * TOKEN_UNIT)
+
+/* Корзина в одном слове для CAS: IP (32 бита), токены (16),
+   время последнего обновления в десятых секунды (16, по модулю) */
+static uint64_t buckets[ADMISSION_TABLE_SIZE];
+static int half_open = 0;
+static uint32_t rejected = 0;
+
+static uint64_t* bucket_slot(uint32_t ip) {
+    uint32_t h = ip * 2654435761u;
+    return &buckets[(h >> 16) & (ADMISSION_TABLE_SIZE - 1)];
+}
+
+static bool bucket_take(uint32_t ip, uint64_t now_ms) {
+    uint64_t* slot = bucket_slot(ip);
+    uint16_t now = (uint16_t)(now_ms / 100);
+    uint64_t old = __atomic_load_n(slot, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t owner = (uint32_t)(old >> 32);
+        uint32_t tokens = TOKENS_FULL;
+
+        if (old != 0) {
+            uint32_t elapsed = (uint16_t)(now - (uint16_t)old);
+            uint32_t refilled = (uint32_t)((old >> 16) & 0xFFFF) +
+                                elapsed * ADMISSION_RATE * (TOKEN_UNIT / 10);
+            if (refilled < tokens) tokens = refilled;
+        }
+
+        /* Слот чужого IP: полную корзину забираем, иначе делим с прежним
+           владельцем - коллизия не должна обнулять чужой лимит */
+        if (old == 0 || (owner != ip && tokens == TOKENS_FULL)) owner = ip;
+
+        if (tokens < TOKEN_UNIT) return false;
+
+        uint64_t updated = ((uint64_t)owner << 32) |
+                           ((uint64_t)(tokens - TOKEN_UNIT) << 16) | now;
+        if (__atomic_compare_exchange_n(slot, &old, updated, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+}
+
+bool admission_try_open(uint32_t ip, uint64_t now_ms) {
+    if (__atomic_fetch_add(&half_open, 1, __ATOMIC_RELAXED) >= ADMISSION_MAX_HALF_OPEN) {
+        __atomic_fetch_sub(&half_open, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&rejected, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    if (!bucket_take(ip, now_ms)) {
+        __atomic_fetch_sub(&half_open, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&rejected, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    return true;
+}
+
+void admission_release() {
+    __atomic_fetch_sub(&half_open, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t admission_take_rejected() {
+    return __atomic_exchange_n(&rejected, 0, __ATOMIC_RELAXED);
+}
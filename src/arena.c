@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include "arena.h"
+#include "globals.h"
+
+#define ARENA_ALIGN 16
+#define ARENA_ROUND(size) (((size) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct {
+    uint8_t* base;
+    size_t used;
+} Arena;
+
+static __thread Arena arena = {0};
+
+void* arena_alloc(size_t size) {
+    if (size == 0 || size > PACKET_ARENA_MAX_ALLOC) return NULL;
+
+    if (!arena.base) {
+        arena.base = malloc(PACKET_ARENA_SIZE);
+        if (!arena.base) return NULL;
+    }
+
+    size_t rounded = ARENA_ROUND(size);
+    if (arena.used + rounded > PACKET_ARENA_SIZE) return NULL;
+
+    void* ptr = arena.base + arena.used;
+    arena.used += rounded;
+
+    return ptr;
+}
+
+bool arena_owns(const void* ptr) {
+    const uint8_t* p = ptr;
+    return arena.base && p >= arena.base && p < arena.base + PACKET_ARENA_SIZE;
+}
+
+bool arena_extend(void* ptr, size_t old_size, size_t new_size) {
+    uint8_t* p = ptr;
+    size_t old_rounded = ARENA_ROUND(old_size);
+    size_t new_rounded = ARENA_ROUND(new_size);
+
+    /* Расширять можно только последний блок */
+    if (!arena_owns(ptr) || p + old_rounded != arena.base + arena.used) return false;
+    if (new_size > PACKET_ARENA_MAX_ALLOC) return false;
+
+    size_t offset = (size_t)(p - arena.base);
+    if (offset + new_rounded > PACKET_ARENA_SIZE) return false;
+
+    arena.used = offset + new_rounded;
+    return true;
+}
+
+void arena_free(void* ptr, size_t size) {
+    uint8_t* p = ptr;
+    if (arena_owns(ptr) && p + ARENA_ROUND(size) == arena.base + arena.used) {
+        arena.used = (size_t)(p - arena.base);
+    }
+}
+
+void arena_reset() {
+    arena.used = 0;
+}
@@ -4,6 +4,28 @@
 #include <math.h>
 #include <time.h>
 #include "server.h"
+#include "protocol.h"
+#include "fluid.h"
+
+/* Версии чанков уникальны глобально: чанк, выгруженный и созданный заново
+   в другом слоте, не совпадёт со старой записью кэша пакетов */
+static uint32_t chunk_version_counter = 0;
+
+/* Отметить изменение блоков чанка */
+static void chunk_touch(Chunk* chunk) {
+    uint32_t version = __atomic_add_fetch(&chunk_version_counter, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&chunk->version, version, __ATOMIC_RELEASE);
+}
+
+uint32_t chunk_version(const Chunk* chunk) {
+    return __atomic_load_n(&chunk->version, __ATOMIC_ACQUIRE);
+}
+
+/* Блоки изменены в обход chunk_set_block (жидкости) */
+void chunk_mark_modified(Chunk* chunk) {
+    chunk->modified = true;
+    chunk_touch(chunk);
+}
 
 /* Простая генерация ландшафта (шум Перлина упрощённо) */
 static int32_t get_terrain_height(int32_t x, int32_t z) {
@@ -86,7 +108,11 @@ void chunk_generate(Chunk* chunk) {
         }
     }
     
+    /* Сгенерированная вода - источники (слот мог остаться от другого чанка) */
+    memset(chunk->fluid_levels, 0, sizeof(chunk->fluid_levels));
+    
     chunk->modified = true;
+    chunk_touch(chunk);
 }
 
 /* Получить блок из чанка */
@@ -113,7 +139,19 @@ static void chunk_set_block(Chunk* chunk, int lx, int ly, int lz, uint8_t block_
     }
     
     chunk->blocks[lx][ly][lz] = block_id;
+    fluid_level_set(chunk, lx, ly, lz, 0);  /* поставленная жидкость - источник */
     chunk->modified = true;
+    chunk_touch(chunk);
+}
+
+/* Найти загруженный чанк. Вызывающий держит chunks_lock */
+Chunk* chunk_find(int32_t x, int32_t z) {
+    for (int i = 0; i < server_state.loaded_chunks; i++) {
+        if (server_state.chunks[i].x == x && server_state.chunks[i].z == z) {
+            return &server_state.chunks[i];
+        }
+    }
+    return NULL;
 }
 
 /* Получить или создать чанк */
@@ -121,13 +159,11 @@ Chunk* chunk_get_or_create(int32_t x, int32_t z) {
     pthread_rwlock_rdlock(&server_state.chunks_lock);
     
     /* Ищем существующий чанк */
-    for (int i = 0; i < server_state.loaded_chunks; i++) {
-        if (server_state.chunks[i].x == x && server_state.chunks[i].z == z) {
-            server_state.chunks[i].last_accessed = (uint32_t)time(NULL);
-            Chunk* result = &server_state.chunks[i];
-            pthread_rwlock_unlock(&server_state.chunks_lock);
-            return result;
-        }
+    Chunk* result = chunk_find(x, z);
+    if (result) {
+        result->last_accessed = (uint32_t)time(NULL);
+        pthread_rwlock_unlock(&server_state.chunks_lock);
+        return result;
     }
     
     pthread_rwlock_unlock(&server_state.chunks_lock);
@@ -202,27 +238,42 @@ void block_set(int32_t x, int32_t y, int32_t z, uint8_t block_id) {
     Chunk* chunk = chunk_get_or_create(chunk_x, chunk_z);
     if (!chunk) return;
     
+    pthread_rwlock_wrlock(&server_state.chunks_lock);
     chunk_set_block(chunk, lx, y, lz, block_id);
+    pthread_rwlock_unlock(&server_state.chunks_lock);
     
     /* Отправляем обновление всем игрокам в радиусе */
+    BroadcastPacket change;
+    broadcast_block_change(&change, x, y, z, block_id);
+    
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket <= 0) continue;
+    /* Дистанции - по горячим массивам, Player нужен только получателю */
+    const PlayerHot* hot = &server_state.hot;
+    for (int i = 0; i < server_state.active_players; i++) {
+        int slot = server_state.active_slots[i];
+        if (!hot->ready[slot]) continue;
         
-        double dx = x - server_state.players[i].x;
-        double dy = y - server_state.players[i].y;
-        double dz = z - server_state.players[i].z;
+        double dx = x - hot->x[slot];
+        double dy = y - hot->y[slot];
+        double dz = z - hot->z[slot];
         double dist_sq = dx*dx + dy*dy + dz*dz;
         
         /* В пределах рендер-дистанции */
         int render_dist = RENDER_DISTANCE * 16;
         if (dist_sq < render_dist * render_dist) {
-            packet_send_block_change(&server_state.players[i], x, y, z, block_id);
+            broadcast_send(&change, &server_state.players[slot]);
         }
     }
     
     pthread_rwlock_unlock(&server_state.players_lock);
+    
+    broadcast_free(&change);
+    
+    /* Рядом с водой или лавой - пусть течёт заново */
+    if (ENABLE_FLUIDS) {
+        fluid_block_changed(x, y, z);
+    }
 }
 
 /* Сохранить чанк на диск */
@@ -242,8 +293,9 @@ void chunk_save(Chunk* chunk) {
     fwrite(&chunk->x, sizeof(int32_t), 1, f);
     fwrite(&chunk->z, sizeof(int32_t), 1, f);
     
-    /* Сохраняем данные блоков */
+    /* Сохраняем данные блоков и уровни жидкостей */
     fwrite(chunk->blocks, sizeof(chunk->blocks), 1, f);
+    fwrite(chunk->fluid_levels, sizeof(chunk->fluid_levels), 1, f);
     
     fclose(f);
     chunk->modified = false;
@@ -281,11 +333,15 @@ void chunk_load(Chunk* chunk) {
         return;
     }
     
-    /* Загружаем данные блоков */
+    /* Загружаем данные блоков. В старых файлах уровней нет - вся жидкость источники */
     fread(chunk->blocks, sizeof(chunk->blocks), 1, f);
+    if (fread(chunk->fluid_levels, sizeof(chunk->fluid_levels), 1, f) != 1) {
+        memset(chunk->fluid_levels, 0, sizeof(chunk->fluid_levels));
+    }
     
     fclose(f);
     chunk->modified = false;
+    chunk_touch(chunk);
     
     if (DEBUG_LOG) {
         printf("[CHUNK] Загружен чанк: (%d, %d) <- %s\n", chunk->x, chunk->z, filename);
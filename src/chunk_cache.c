@@ -0,0 +1,62 @@
+#include <pthread.h>
+#include "globals.h"
+#include "chunk_cache.h"
+
+/* Прямое отображение: координаты чанка выбирают один слот */
+typedef struct {
+    int32_t x, z;
+    uint32_t version;
+    bool compressed;
+    Frame* frame;  /* NULL - слот пуст */
+} ChunkCacheEntry;
+
+static ChunkCacheEntry entries[CHUNK_PACKET_CACHE_SIZE];
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static ChunkCacheEntry* cache_slot(int32_t x, int32_t z) {
+    uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)z * 19349663u;
+    return &entries[h & (CHUNK_PACKET_CACHE_SIZE - 1)];
+}
+
+Frame* chunk_cache_lookup(int32_t x, int32_t z, uint32_t version, bool compressed) {
+    Frame* frame = NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    ChunkCacheEntry* entry = cache_slot(x, z);
+    /* Кадр, который не удалось сжать, собирается заново */
+    if (entry->frame && entry->x == x && entry->z == z &&
+        entry->version == version && entry->compressed == compressed &&
+        !frame_is_failed(entry->frame)) {
+        frame = entry->frame;
+        frame_retain(frame);
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    return frame;
+}
+
+void chunk_cache_store(int32_t x, int32_t z, uint32_t version, bool compressed, Frame* frame) {
+    frame_retain(frame);
+
+    pthread_mutex_lock(&cache_lock);
+    ChunkCacheEntry* entry = cache_slot(x, z);
+    Frame* old = entry->frame;
+    entry->x = x;
+    entry->z = z;
+    entry->version = version;
+    entry->compressed = compressed;
+    entry->frame = frame;
+    pthread_mutex_unlock(&cache_lock);
+
+    /* Очереди, где старый кадр ещё ждёт отправки, держат свои ссылки */
+    frame_release(old);
+}
+
+void chunk_cache_clear() {
+    pthread_mutex_lock(&cache_lock);
+    for (int i = 0; i < CHUNK_PACKET_CACHE_SIZE; i++) {
+        frame_release(entries[i].frame);
+        entries[i].frame = NULL;
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
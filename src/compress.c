@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#include "globals.h"
+#include "compress.h"
+#include "varint.h"
+
+/* Резерв перед сжатыми данными: VarInt длины кадра (до 3 байт)
+   и VarInt Data Length (до 5 байт) */
+#define COMPRESS_HEADROOM 8
+
+/* Задание пула: тело копируется сюда же, за структурой */
+typedef struct CompressJob {
+    struct CompressJob* next;
+    Frame* frame;
+    size_t body_len;
+    uint8_t body[];
+} CompressJob;
+
+/* === СОСТОЯНИЕ ПУЛА === */
+
+static pthread_t compress_threads[COMPRESSION_THREADS];
+static int compress_thread_count = 0;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static CompressJob* queue_head = NULL;
+static CompressJob* queue_tail = NULL;
+static bool queue_stop = false;
+
+/* Потоки сжимают много мелких тел подряд - потоки zlib переиспользуются */
+static __thread z_stream deflate_stream;
+static __thread bool deflate_ready = false;
+static __thread z_stream inflate_stream;
+static __thread bool inflate_ready = false;
+
+/* === СЖАТИЕ === */
+
+size_t compress_frame_bound(size_t body_len) {
+    return COMPRESS_HEADROOM + compressBound((uLong)body_len);
+}
+
+uint8_t* compress_frame(const uint8_t* body, size_t body_len,
+                        uint8_t* out, size_t cap, size_t* frame_len) {
+    if (!deflate_ready) {
+        memset(&deflate_stream, 0, sizeof(deflate_stream));
+        if (deflateInit(&deflate_stream, COMPRESSION_LEVEL) != Z_OK) return NULL;
+        deflate_ready = true;
+    } else {
+        deflateReset(&deflate_stream);
+    }
+
+    deflate_stream.next_in = (Bytef*)body;
+    deflate_stream.avail_in = (uInt)body_len;
+    deflate_stream.next_out = out + COMPRESS_HEADROOM;
+    deflate_stream.avail_out = (uInt)(cap - COMPRESS_HEADROOM);
+
+    if (deflate(&deflate_stream, Z_FINISH) != Z_STREAM_END) return NULL;
+
+    size_t compressed = deflate_stream.total_out;
+
+    /* Заголовок пишется вплотную к сжатым данным, назад */
+    int data_len_len = varint_size((uint32_t)body_len);
+    uint32_t packet_len = (uint32_t)(data_len_len + compressed);
+    int packet_len_len = varint_size(packet_len);
+
+    uint8_t* start = out + COMPRESS_HEADROOM - data_len_len - packet_len_len;
+    varint_encode(start, packet_len);
+    varint_encode(start + packet_len_len, (uint32_t)body_len);
+
+    *frame_len = (size_t)packet_len_len + packet_len;
+    return start;
+}
+
+static void compress_job_run(CompressJob* job) {
+    Frame* frame = job->frame;
+    uint8_t* start = compress_frame(job->body, job->body_len,
+                                    frame->buf, frame->cap, &frame->len);
+
+    /* Буфер рассчитан на compressBound - deflate падает только без памяти.
+       Отправить тело несжатым нельзя: клиент отвергнет несжатый пакет
+       не меньше порога, поэтому соединения с этим кадром закрываются */
+    if (start) {
+        frame->data = start;
+        frame_set_ready(frame);
+    } else {
+        printf("[COMPRESS] Не удалось сжать тело %zu байт\n", job->body_len);
+        frame_set_failed(frame);
+    }
+
+    frame_release(frame);
+    free(job);
+}
+
+static void* compress_thread_func(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue_lock);
+        while (!queue_head && !queue_stop) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+
+        /* Остановка только после того, как очередь выбрана */
+        CompressJob* job = queue_head;
+        if (!job) {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        queue_head = job->next;
+        if (!queue_head) queue_tail = NULL;
+        pthread_mutex_unlock(&queue_lock);
+
+        compress_job_run(job);
+    }
+
+    if (deflate_ready) deflateEnd(&deflate_stream);
+    return NULL;
+}
+
+Frame* compress_frame_async(const uint8_t* body, size_t body_len) {
+    /* Несжимаемые данные могут вырасти - буфер с запасом */
+    Frame* frame = frame_alloc(compress_frame_bound(body_len));
+    if (!frame) return NULL;
+
+    CompressJob* job = malloc(sizeof(CompressJob) + body_len);
+    if (!job) {
+        frame_release(frame);
+        return NULL;
+    }
+
+    job->next = NULL;
+    job->frame = frame;
+    job->body_len = body_len;
+    memcpy(job->body, body, body_len);
+
+    /* Вторая ссылка - у задания */
+    frame_retain(frame);
+
+    if (compress_thread_count == 0) {
+        compress_job_run(job);
+        return frame;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    if (queue_tail) {
+        queue_tail->next = job;
+    } else {
+        queue_head = job;
+    }
+    queue_tail = job;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+
+    return frame;
+}
+
+/* === РАСПАКОВКА === */
+
+bool compress_inflate(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_len) {
+    if (!inflate_ready) {
+        memset(&inflate_stream, 0, sizeof(inflate_stream));
+        if (inflateInit(&inflate_stream) != Z_OK) return false;
+        inflate_ready = true;
+    } else {
+        inflateReset(&inflate_stream);
+    }
+
+    inflate_stream.next_in = (Bytef*)in;
+    inflate_stream.avail_in = (uInt)in_len;
+    inflate_stream.next_out = out;
+    inflate_stream.avail_out = (uInt)out_len;
+
+    /* Ровно out_len байт и конец потока: ни меньше, ни больше заявленного */
+    return inflate(&inflate_stream, Z_FINISH) == Z_STREAM_END &&
+           inflate_stream.total_out == out_len;
+}
+
+/* === ПУЛ === */
+
+bool compress_init() {
+    queue_stop = false;
+
+    for (int i = 0; i < COMPRESSION_THREADS; i++) {
+        if (pthread_create(&compress_threads[i], NULL, compress_thread_func, NULL) != 0) {
+            perror("[ERROR] Не удалось создать поток сжатия");
+            compress_shutdown();
+            return false;
+        }
+        compress_thread_count++;
+    }
+
+    printf("[COMPRESS] Сжатие: порог %d байт, уровень %d, потоков %d\n",
+           COMPRESSION_THRESHOLD, COMPRESSION_LEVEL, compress_thread_count);
+    return true;
+}
+
+void compress_shutdown() {
+    pthread_mutex_lock(&queue_lock);
+    queue_stop = true;
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+
+    for (int i = 0; i < compress_thread_count; i++) {
+        pthread_join(compress_threads[i], NULL);
+    }
+    compress_thread_count = 0;
+}
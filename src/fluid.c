@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fluid.h"
+#include "limits.h"
+#include "protocol.h"
+#include "grid.h"
+
+/* === ОЧЕРЕДИ ЖИДКОСТЕЙ === */
+
+#define FLUID_QUEUE_MASK (FLUID_QUEUE_SIZE - 1)
+#define FLUID_SET_SIZE (FLUID_QUEUE_SIZE * 4)  /* обе очереди, заполнение до половины */
+#define FLUID_SET_MASK (FLUID_SET_SIZE - 1)
+#define FLUID_MAX_LEVEL 7
+#define FLUID_CHUNK_SLOTS 16  /* чанков в кэше поиска на фазу (степень двойки) */
+
+enum { FLUID_WATER, FLUID_LAVA, FLUID_TYPES };
+
+typedef struct {
+    uint64_t key;
+    uint32_t due;  /* номер фазы, с которой позицию можно обработать */
+} FluidEntry;
+
+/* Кольцо FIFO: задержка у жидкости одна, поэтому due в нём не убывает */
+typedef struct {
+    uint8_t block;
+    uint8_t step;    /* на сколько растёт уровень за блок в сторону */
+    uint32_t delay;  /* фаз от изменения до перепроверки */
+    uint32_t head, tail;
+    FluidEntry entries[FLUID_QUEUE_SIZE];
+} FluidQueue;
+
+static FluidQueue queues[FLUID_TYPES] = {
+    [FLUID_WATER] = { BLOCK_WATER, 1, 1, 0, 0, { { 0, 0 } } },
+    [FLUID_LAVA]  = { BLOCK_LAVA, 2, FLUID_LAVA_DELAY, 0, 0, { { 0, 0 } } },
+};
+
+/* Ключи позиций в очередях (0 - пусто): одна позиция - одна запись */
+static uint64_t queued[FLUID_SET_SIZE];
+static uint32_t fluid_phase = 0;
+static uint64_t dropped = 0;
+
+/* Ключ: x, z по 26 бит, y - 8, жидкость, младший бит - признак занятости */
+static inline uint64_t pos_key(int32_t x, int32_t y, int32_t z, int fluid) {
+    return ((uint64_t)(x & 0x3FFFFFF) << 36) | ((uint64_t)(z & 0x3FFFFFF) << 10) |
+           ((uint64_t)(y & 0xFF) << 2) | ((uint64_t)fluid << 1) | 1;
+}
+
+static inline int32_t key_x(uint64_t key) {
+    return (int32_t)((uint32_t)(key >> 36) << 6) >> 6;
+}
+
+static inline int32_t key_z(uint64_t key) {
+    return (int32_t)((uint32_t)(key >> 10) << 6) >> 6;
+}
+
+static inline int32_t key_y(uint64_t key) {
+    return (int32_t)((key >> 2) & 0xFF);
+}
+
+static inline uint32_t key_slot(uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 40) & FLUID_SET_MASK;
+}
+
+/* false - позиция уже в очереди */
+static bool set_insert(uint64_t key) {
+    uint32_t i = key_slot(key);
+    while (queued[i]) {
+        if (queued[i] == key) return false;
+        i = (i + 1) & FLUID_SET_MASK;
+    }
+    queued[i] = key;
+    return true;
+}
+
+/* Удаление со сдвигом назад: цепочки пробирования остаются без дыр */
+static void set_remove(uint64_t key) {
+    uint32_t i = key_slot(key);
+    while (queued[i] != key) {
+        if (!queued[i]) return;
+        i = (i + 1) & FLUID_SET_MASK;
+    }
+
+    uint32_t hole = i;
+    for (;;) {
+        i = (i + 1) & FLUID_SET_MASK;
+        if (!queued[i]) break;
+
+        /* Ключ можно перенести в дыру, если она между его домом и ним */
+        uint32_t home = key_slot(queued[i]);
+        if (((i - home) & FLUID_SET_MASK) >= ((i - hole) & FLUID_SET_MASK)) {
+            queued[hole] = queued[i];
+            hole = i;
+        }
+    }
+    queued[hole] = 0;
+}
+
+static void schedule(int32_t x, int32_t y, int32_t z, int fluid) {
+    if (y < 0 || y >= 256) return;
+
+    FluidQueue* queue = &queues[fluid];
+    if (queue->tail - queue->head >= FLUID_QUEUE_SIZE) {
+        dropped++;
+        return;
+    }
+
+    uint64_t key = pos_key(x, y, z, fluid);
+    if (!set_insert(key)) return;
+
+    FluidEntry* entry = &queue->entries[queue->tail++ & FLUID_QUEUE_MASK];
+    entry->key = key;
+    entry->due = fluid_phase + queue->delay;
+}
+
+/* === ДОСТУП К МИРУ === */
+
+/* Линейный поиск чанка дорог на каждого соседа - кэш на время блокировки */
+typedef struct {
+    int32_t x, z;
+    Chunk* chunk;
+    bool valid;
+} ChunkSlot;
+
+static ChunkSlot chunk_slots[FLUID_CHUNK_SLOTS];
+
+static void chunk_slots_reset() {
+    for (int i = 0; i < FLUID_CHUNK_SLOTS; i++) chunk_slots[i].valid = false;
+}
+
+static Chunk* fluid_chunk(int32_t chunk_x, int32_t chunk_z) {
+    ChunkSlot* slot = &chunk_slots[(uint32_t)(chunk_x * 31 + chunk_z) & (FLUID_CHUNK_SLOTS - 1)];
+    if (!slot->valid || slot->x != chunk_x || slot->z != chunk_z) {
+        slot->x = chunk_x;
+        slot->z = chunk_z;
+        slot->chunk = chunk_find(chunk_x, chunk_z);
+        slot->valid = true;
+    }
+    return slot->chunk;
+}
+
+typedef struct {
+    uint8_t block;
+    uint8_t level;
+} Cell;
+
+/* Блок для жидкости: незагруженные чанки и y < 0 - твёрдые, течь туда некуда */
+static Cell cell_get(int32_t x, int32_t y, int32_t z) {
+    Cell cell = { BLOCK_BEDROCK, 0 };
+    if (y >= 256) {
+        cell.block = BLOCK_AIR;
+        return cell;
+    }
+    if (y < 0) return cell;
+
+    Chunk* chunk = fluid_chunk(x >> 4, z >> 4);
+    if (!chunk) return cell;
+
+    cell.block = chunk->blocks[x & 15][y][z & 15];
+    cell.level = fluid_level_get(chunk, x & 15, y, z & 15);
+    return cell;
+}
+
+static inline bool is_fluid(uint8_t block) {
+    return block == BLOCK_WATER || block == BLOCK_LAVA;
+}
+
+/* Опора: стоящая на ней жидкость не падает, а растекается в стороны */
+static inline bool cell_supports(Cell cell) {
+    return cell.block != BLOCK_AIR && !(is_fluid(cell.block) && cell.level != 0);
+}
+
+static const int side_x[4] = { 1, -1, 0, 0 };
+static const int side_z[4] = { 0, 0, 1, -1 };
+
+static const int near_x[6] = { 1, -1, 0, 0, 0, 0 };
+static const int near_y[6] = { 0, 0, 0, 0, 1, -1 };
+static const int near_z[6] = { 0, 0, 1, -1, 0, 0 };
+
+static bool touches_water(int32_t x, int32_t y, int32_t z) {
+    for (int d = 0; d < 5; d++) {
+        if (cell_get(x + near_x[d], y + near_y[d], z + near_z[d]).block == BLOCK_WATER) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* === ИЗМЕНЕНИЯ ДЛЯ КЛИЕНТОВ === */
+
+typedef struct {
+    uint64_t section;  /* x, z чанка и y секции - ключ группировки */
+    uint32_t order;    /* порядок изменений внутри секции сохраняется */
+    BlockUpdate update;
+} FluidChange;
+
+static FluidChange changes[FLUID_FLOW_LIMIT];
+static BlockUpdate batch[FLUID_FLOW_LIMIT];
+static int change_count = 0;
+
+static int change_compare(const void* a, const void* b) {
+    const FluidChange* left = a;
+    const FluidChange* right = b;
+    if (left->section != right->section) return left->section < right->section ? -1 : 1;
+    return left->order < right->order ? -1 : 1;
+}
+
+static void section_visit(Player* player, void* arg) {
+    if (player_ready(player)) broadcast_send(arg, player);
+}
+
+/* Один пакет на секцию - тем, у кого её чанк в пределах RENDER_DISTANCE */
+static void flush_changes() {
+    if (change_count == 0) return;
+
+    qsort(changes, (size_t)change_count, sizeof(FluidChange), change_compare);
+
+    pthread_rwlock_rdlock(&server_state.players_lock);
+
+    for (int first = 0; first < change_count; ) {
+        int count = 0;
+        int last = first;
+        while (last < change_count && changes[last].section == changes[first].section) {
+            batch[count++] = changes[last++].update;
+        }
+
+        BroadcastPacket packet;
+        broadcast_section_blocks(&packet, batch, count);
+        grid_query((double)batch[0].x, (double)batch[0].z, RENDER_DISTANCE,
+                   section_visit, &packet);
+        broadcast_free(&packet);
+
+        first = last;
+    }
+
+    pthread_rwlock_unlock(&server_state.players_lock);
+
+    change_count = 0;
+}
+
+static void change_record(int32_t x, int32_t y, int32_t z, uint8_t block) {
+    if (change_count == FLUID_FLOW_LIMIT) flush_changes();
+
+    FluidChange* change = &changes[change_count];
+    change->section = ((uint64_t)((x >> 4) & 0x3FFFFFF) << 38) |
+                      ((uint64_t)((z >> 4) & 0x3FFFFFF) << 12) | (uint64_t)(y >> 4);
+    change->order = (uint32_t)change_count;
+    change->update.x = x;
+    change->update.y = y;
+    change->update.z = z;
+    change->update.block_id = block;
+    change_count++;
+}
+
+/* === ТЕЧЕНИЕ === */
+
+/* Записать блок и поставить соседей в очередь той же жидкости */
+static void cell_set(int32_t x, int32_t y, int32_t z, uint8_t block, uint8_t level, int fluid) {
+    Chunk* chunk = fluid_chunk(x >> 4, z >> 4);
+    if (!chunk) return;
+
+    chunk->blocks[x & 15][y][z & 15] = block;
+    fluid_level_set(chunk, x & 15, y, z & 15, level);
+    chunk_mark_modified(chunk);
+    change_record(x, y, z, block);
+
+    for (int d = 0; d < 6; d++) {
+        schedule(x + near_x[d], y + near_y[d], z + near_z[d], fluid);
+    }
+}
+
+/* Каким должен быть уровень жидкости type в позиции (-1 - её там нет) */
+static int desired_level(int32_t x, int32_t y, int32_t z, const FluidQueue* queue, Cell cell) {
+    uint8_t type = queue->block;
+
+    /* Источники меняет только игрок */
+    if (cell.block == type && cell.level == 0) return 0;
+
+    if (cell_get(x, y + 1, z).block == type) return FLUID_FALLING;
+
+    int best = -1;
+    int sources = 0;
+
+    for (int d = 0; d < 4; d++) {
+        Cell side = cell_get(x + side_x[d], y, z + side_z[d]);
+        if (side.block != type) continue;
+        if (side.level == 0) sources++;
+
+        /* Соседу есть куда падать - в стороны он не течёт */
+        if (!cell_supports(cell_get(x + side_x[d], y - 1, z + side_z[d]))) continue;
+
+        int level = (side.level >= FLUID_FALLING ? 0 : side.level) + queue->step;
+        if (level <= FLUID_MAX_LEVEL && (best < 0 || level < best)) best = level;
+    }
+
+    /* Вода между двумя источниками над опорой - новый источник */
+    if (type == BLOCK_WATER && sources >= 2 && cell_supports(cell_get(x, y - 1, z))) {
+        return 0;
+    }
+    return best;
+}
+
+/* Устоявшаяся жидкость течёт дальше: вниз, а если там опора - в стороны */
+static void spread(int32_t x, int32_t y, int32_t z, int fluid) {
+    Cell below = cell_get(x, y - 1, z);
+    if (!cell_supports(below)) {
+        if (below.block == BLOCK_AIR) schedule(x, y - 1, z, fluid);
+        return;
+    }
+
+    for (int d = 0; d < 4; d++) {
+        if (cell_get(x + side_x[d], y, z + side_z[d]).block == BLOCK_AIR) {
+            schedule(x + side_x[d], y, z + side_z[d], fluid);
+        }
+    }
+}
+
+static void fluid_update(int32_t x, int32_t y, int32_t z, int fluid) {
+    const FluidQueue* queue = &queues[fluid];
+    Cell cell = cell_get(x, y, z);
+
+    /* Лава, которой коснулась вода, застывает */
+    if (cell.block == BLOCK_LAVA && touches_water(x, y, z)) {
+        cell_set(x, y, z, cell.level == 0 ? BLOCK_OBSIDIAN : BLOCK_COBBLESTONE, 0, fluid);
+        return;
+    }
+    if (cell.block != BLOCK_AIR && cell.block != queue->block) return;
+
+    int desired = desired_level(x, y, z, queue, cell);
+    int current = cell.block == queue->block ? cell.level : -1;
+
+    if (desired == current) {
+        if (current >= 0) spread(x, y, z, fluid);
+    } else if (desired < 0) {
+        cell_set(x, y, z, BLOCK_AIR, 0, fluid);
+    } else if (queue->block == BLOCK_LAVA && touches_water(x, y, z)) {
+        cell_set(x, y, z, BLOCK_COBBLESTONE, 0, fluid);
+    } else {
+        cell_set(x, y, z, queue->block, (uint8_t)desired, fluid);
+    }
+}
+
+/* === ФАЗА === */
+
+void fluid_init() {
+    for (int fluid = 0; fluid < FLUID_TYPES; fluid++) {
+        queues[fluid].head = 0;
+        queues[fluid].tail = 0;
+    }
+    memset(queued, 0, sizeof(queued));
+    fluid_phase = 0;
+    dropped = 0;
+    change_count = 0;
+}
+
+void fluid_block_changed(int32_t x, int32_t y, int32_t z) {
+    bool found[FLUID_TYPES] = { false, false };
+
+    pthread_rwlock_rdlock(&server_state.chunks_lock);
+    chunk_slots_reset();
+
+    for (int d = -1; d < 6; d++) {
+        uint8_t block = d < 0 ? cell_get(x, y, z).block
+                              : cell_get(x + near_x[d], y + near_y[d], z + near_z[d]).block;
+        if (block == BLOCK_WATER) found[FLUID_WATER] = true;
+        if (block == BLOCK_LAVA) found[FLUID_LAVA] = true;
+    }
+
+    pthread_rwlock_unlock(&server_state.chunks_lock);
+
+    for (int fluid = 0; fluid < FLUID_TYPES; fluid++) {
+        if (!found[fluid]) continue;
+
+        schedule(x, y, z, fluid);
+        for (int d = 0; d < 6; d++) {
+            schedule(x + near_x[d], y + near_y[d], z + near_z[d], fluid);
+        }
+    }
+}
+
+/* Очередь с самой старой созревшей позицией, NULL - созревших нет */
+static FluidQueue* next_queue() {
+    FluidQueue* next = NULL;
+    uint32_t next_due = 0;
+
+    for (int fluid = 0; fluid < FLUID_TYPES; fluid++) {
+        FluidQueue* queue = &queues[fluid];
+        if (queue->head == queue->tail) continue;
+
+        uint32_t due = queue->entries[queue->head & FLUID_QUEUE_MASK].due;
+        if ((int32_t)(due - fluid_phase) > 0) continue;
+        if (!next || (int32_t)(due - next_due) < 0) {
+            next = queue;
+            next_due = due;
+        }
+    }
+    return next;
+}
+
+void fluid_tick(int budget) {
+    fluid_phase++;
+
+    /* Фаза пишет блоки и уровни - под записью: сериализатор чанков не
+       увидит полуприменённого течения, чанки не выгружаются и не сдвигаются */
+    pthread_rwlock_wrlock(&server_state.chunks_lock);
+    chunk_slots_reset();
+
+    for (int processed = 0; processed < budget; processed++) {
+        FluidQueue* queue = next_queue();
+        if (!queue) break;
+
+        uint64_t key = queue->entries[queue->head++ & FLUID_QUEUE_MASK].key;
+        set_remove(key);
+        fluid_update(key_x(key), key_y(key), key_z(key), (int)(queue - queues));
+    }
+
+    pthread_rwlock_unlock(&server_state.chunks_lock);
+
+    flush_changes();
+
+    if (dropped > 0) {
+        printf("[FLUID] Очередь переполнена: пропущено %llu обновлений\n",
+               (unsigned long long)dropped);
+        dropped = 0;
+    }
+}
+
+size_t fluid_pending() {
+    size_t pending = 0;
+    for (int fluid = 0; fluid < FLUID_TYPES; fluid++) {
+        pending += queues[fluid].tail - queues[fluid].head;
+    }
+    return pending;
+}
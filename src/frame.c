@@ -0,0 +1,41 @@
+#include <stdlib.h>
+#include "frame.h"
+
+Frame* frame_alloc(size_t cap) {
+    Frame* frame = malloc(sizeof(Frame) + cap);
+    if (!frame) return NULL;
+
+    frame->refs = 1;
+    frame->ready = 0;
+    frame->data = frame->buf;
+    frame->len = 0;
+    frame->cap = cap;
+    return frame;
+}
+
+void frame_retain(Frame* frame) {
+    __atomic_fetch_add(&frame->refs, 1, __ATOMIC_RELAXED);
+}
+
+void frame_release(Frame* frame) {
+    if (!frame) return;
+    if (__atomic_sub_fetch(&frame->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(frame);
+    }
+}
+
+void frame_set_ready(Frame* frame) {
+    __atomic_store_n(&frame->ready, 1, __ATOMIC_RELEASE);
+}
+
+bool frame_is_ready(const Frame* frame) {
+    return __atomic_load_n(&frame->ready, __ATOMIC_ACQUIRE) > 0;
+}
+
+void frame_set_failed(Frame* frame) {
+    __atomic_store_n(&frame->ready, -1, __ATOMIC_RELEASE);
+}
+
+bool frame_is_failed(const Frame* frame) {
+    return __atomic_load_n(&frame->ready, __ATOMIC_ACQUIRE) < 0;
+}
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <stdbool.h>
+#include "grid.h"
+
+#define GRID_MASK (GRID_BUCKETS - 1)
+#define GRID_NONE (-1)
+
+/* Узлы списков - отдельно от Player: слот обнуляется при подключении,
+   а связи должны жить до grid_remove */
+typedef struct {
+    int32_t next, prev;
+    int32_t cell_x, cell_z;
+    bool linked;
+} GridNode;
+
+static int32_t buckets[GRID_BUCKETS];
+static uint64_t occupied[GRID_BUCKETS / 64];  /* непустые корзины */
+static GridNode nodes[MAX_PLAYERS];
+
+static inline int32_t cell_of(double coord) {
+    return (int32_t)floor(coord) >> 4;
+}
+
+/* Ряд ячеек с одним cell_x лежит в подряд идущих корзинах: запрос
+   читает ряд одним окном битовой карты, а не хеширует каждую ячейку */
+static inline uint32_t row_base(int32_t cell_x) {
+    uint32_t h = (uint32_t)cell_x * 2654435761u;
+    return h ^ (h >> 15);
+}
+
+static inline uint32_t bucket_of(int32_t cell_x, int32_t cell_z) {
+    return (row_base(cell_x) + (uint32_t)cell_z) & GRID_MASK;
+}
+
+/* len (до 63) бит карты занятости начиная с корзины start, по кругу */
+static inline uint64_t occupied_window(uint32_t start, int len) {
+    uint32_t word = start >> 6;
+    uint32_t shift = start & 63;
+    uint64_t bits = occupied[word] >> shift;
+
+    if (shift + (uint32_t)len > 64) {
+        bits |= occupied[(word + 1) & (GRID_BUCKETS / 64 - 1)] << (64 - shift);
+    }
+    return bits & ((1ULL << len) - 1);
+}
+
+void grid_init() {
+    for (int i = 0; i < GRID_BUCKETS; i++) buckets[i] = GRID_NONE;
+    for (int i = 0; i < GRID_BUCKETS / 64; i++) occupied[i] = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) nodes[i].linked = false;
+}
+
+static void node_link(int32_t slot, int32_t cell_x, int32_t cell_z) {
+    GridNode* node = &nodes[slot];
+    uint32_t bucket = bucket_of(cell_x, cell_z);
+    int32_t* head = &buckets[bucket];
+
+    node->cell_x = cell_x;
+    node->cell_z = cell_z;
+    node->prev = GRID_NONE;
+    node->next = *head;
+    if (*head != GRID_NONE) nodes[*head].prev = slot;
+    *head = slot;
+    occupied[bucket >> 6] |= 1ULL << (bucket & 63);
+    node->linked = true;
+}
+
+static void node_unlink(int32_t slot) {
+    GridNode* node = &nodes[slot];
+
+    if (node->prev != GRID_NONE) {
+        nodes[node->prev].next = node->next;
+    } else {
+        uint32_t bucket = bucket_of(node->cell_x, node->cell_z);
+        buckets[bucket] = node->next;
+        if (node->next == GRID_NONE) occupied[bucket >> 6] &= ~(1ULL << (bucket & 63));
+    }
+    if (node->next != GRID_NONE) nodes[node->next].prev = node->prev;
+    node->linked = false;
+}
+
+void grid_insert(Player* player) {
+    int32_t slot = player_slot(player);
+    if (nodes[slot].linked) node_unlink(slot);
+    node_link(slot, cell_of(server_state.hot.x[slot]), cell_of(server_state.hot.z[slot]));
+}
+
+void grid_remove(Player* player) {
+    int32_t slot = player_slot(player);
+    if (nodes[slot].linked) node_unlink(slot);
+}
+
+void grid_move(Player* player) {
+    int32_t slot = player_slot(player);
+    GridNode* node = &nodes[slot];
+    if (!node->linked) return;
+
+    int32_t cell_x = cell_of(server_state.hot.x[slot]);
+    int32_t cell_z = cell_of(server_state.hot.z[slot]);
+    if (cell_x == node->cell_x && cell_z == node->cell_z) return;
+
+    node_unlink(slot);
+    node_link(slot, cell_x, cell_z);
+}
+
+void grid_query(double x, double z, int radius, GridVisit visit, void* arg) {
+    int32_t center_x = cell_of(x);
+    int32_t center_z = cell_of(z);
+
+    for (int32_t cx = center_x - radius; cx <= center_x + radius; cx++) {
+        uint32_t base = row_base(cx);
+
+        /* Ряд - кусками по 63 ячейки, пустые корзины пропускаются по карте */
+        for (int32_t first = center_z - radius; first <= center_z + radius; first += 63) {
+            int len = center_z + radius - first + 1;
+            if (len > 63) len = 63;
+
+            uint64_t bits = occupied_window((base + (uint32_t)first) & GRID_MASK, len);
+            while (bits) {
+                int32_t cz = first + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                /* В корзине могут лежать и другие ячейки - сверяем координаты */
+                for (int32_t slot = buckets[(base + (uint32_t)cz) & GRID_MASK];
+                     slot != GRID_NONE; slot = nodes[slot].next) {
+                    if (nodes[slot].cell_x == cx && nodes[slot].cell_z == cz) {
+                        visit(&server_state.players[slot], arg);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "globals.h"
+#include "jobs.h"
+#include "arena.h"
+
+#define JOB_DEQUE_MASK (JOB_DEQUE_SIZE - 1)
+#define JOB_SPIN 2000  /* попыток перехвата до сна */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() __asm__ volatile("" ::: "memory")
+#endif
+
+/* Дек Чейза-Ли фиксированного размера: bottom пишет только владелец,
+   top сдвигают CAS и владелец (последний элемент), и воры */
+typedef struct {
+    int64_t top;
+    char pad0[64 - sizeof(int64_t)];
+    int64_t bottom;
+    char pad1[64 - sizeof(int64_t)];
+    Job* buffer[JOB_DEQUE_SIZE];
+} JobDeque;
+
+/* Очередь 0 - у вызывающего потока (тик), 1..JOB_THREADS - у пула */
+static JobDeque deques[JOB_THREADS + 1];
+static pthread_t job_threads[JOB_THREADS > 0 ? JOB_THREADS : 1];
+static int job_thread_count = 0;
+static __thread int worker_index = 0;
+
+/* Сон свободных потоков: epoch растёт при каждой новой работе */
+static pthread_mutex_t sleep_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sleep_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t epoch = 0;
+static int sleepers = 0;
+static bool stop = false;
+
+/* === ДЕК === */
+
+static bool deque_push(JobDeque* d, Job* job) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    if (b - t >= JOB_DEQUE_SIZE) return false;
+
+    __atomic_store_n(&d->buffer[b & JOB_DEQUE_MASK], job, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static Job* deque_pop(JobDeque* d) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    Job* job = __atomic_load_n(&d->buffer[b & JOB_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (t == b) {
+        /* Последний элемент - наперегонки с ворами */
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            job = NULL;
+        }
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+static Job* deque_steal(JobDeque* d) {
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b) return NULL;
+
+    Job* job = __atomic_load_n(&d->buffer[t & JOB_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    return job;
+}
+
+/* === ВЫПОЛНЕНИЕ === */
+
+static void job_run(Job* job) {
+    job->func(job->arg, job->begin, job->end);
+    __atomic_fetch_sub(&job->group->pending, 1, __ATOMIC_RELEASE);
+}
+
+/* Своя очередь, затем чужие по кругу */
+static Job* job_find() {
+    Job* job = deque_pop(&deques[worker_index]);
+    if (job) return job;
+
+    for (int i = 1; i <= JOB_THREADS; i++) {
+        int victim = (worker_index + i) % (JOB_THREADS + 1);
+        job = deque_steal(&deques[victim]);
+        if (job) return job;
+    }
+    return NULL;
+}
+
+static void wake_workers() {
+    __atomic_fetch_add(&epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&sleep_lock);
+        pthread_cond_broadcast(&sleep_cond);
+        pthread_mutex_unlock(&sleep_lock);
+    }
+}
+
+static void* job_thread_func(void* arg) {
+    worker_index = (int)(intptr_t)arg;
+
+    while (!__atomic_load_n(&stop, __ATOMIC_ACQUIRE)) {
+        uint32_t seen = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+
+        for (int spin = 0; spin < JOB_SPIN; spin++) {
+            Job* job = job_find();
+            if (job) {
+                job_run(job);
+                arena_reset();  /* буферы задания больше не нужны */
+                spin = 0;
+                seen = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+            } else {
+                cpu_relax();
+            }
+        }
+
+        /* Засыпаем, только если с начала поиска новой работы не появилось */
+        pthread_mutex_lock(&sleep_lock);
+        __atomic_fetch_add(&sleepers, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&epoch, __ATOMIC_SEQ_CST) == seen &&
+               !__atomic_load_n(&stop, __ATOMIC_ACQUIRE)) {
+            pthread_cond_wait(&sleep_cond, &sleep_lock);
+        }
+        __atomic_fetch_sub(&sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&sleep_lock);
+    }
+
+    return NULL;
+}
+
+/* === API === */
+
+void jobs_spawn(JobGroup* group, Job* job) {
+    job->group = group;
+    __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+
+    /* Без пула или при полной очереди - сразу здесь */
+    if (job_thread_count == 0 || !deque_push(&deques[worker_index], job)) {
+        job_run(job);
+        return;
+    }
+    wake_workers();
+}
+
+void jobs_wait(JobGroup* group) {
+    int idle = 0;
+
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        Job* job = job_find();
+        if (job) {
+            job_run(job);
+            idle = 0;
+        } else if (++idle < JOB_SPIN) {
+            cpu_relax();
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+void jobs_parallel_for(int count, int grain, JobFunc func, void* arg) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    /* Кусков не больше JOB_MAX_CHUNKS: задания лежат на стеке до join */
+    int chunks = (count + grain - 1) / grain;
+    if (chunks > JOB_MAX_CHUNKS) {
+        chunks = JOB_MAX_CHUNKS;
+        grain = (count + chunks - 1) / chunks;
+        chunks = (count + grain - 1) / grain;
+    }
+
+    if (chunks == 1 || job_thread_count == 0) {
+        func(arg, 0, count);
+        return;
+    }
+
+    Job jobs[JOB_MAX_CHUNKS];
+    JobGroup group = { 0 };
+
+    /* Первый кусок - себе, остальные - в очередь на перехват */
+    for (int i = 1; i < chunks; i++) {
+        int begin = i * grain;
+        int end = begin + grain < count ? begin + grain : count;
+        jobs[i] = (Job){ .func = func, .arg = arg, .begin = begin, .end = end };
+        jobs_spawn(&group, &jobs[i]);
+    }
+
+    func(arg, 0, grain);
+    jobs_wait(&group);
+}
+
+int jobs_concurrency() {
+    return job_thread_count + 1;
+}
+
+bool jobs_init() {
+    stop = false;
+
+    /* Потоку тика - своё ядро: лишние потоки только отбирали бы его
+       ожиданием в цикле перехвата */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = JOB_THREADS;
+    if (cpus > 0 && threads > cpus - 1) threads = (int)cpus - 1;
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&job_threads[i], NULL, job_thread_func,
+                           (void*)(intptr_t)(i + 1)) != 0) {
+            perror("[ERROR] Не удалось создать поток заданий");
+            jobs_shutdown();
+            return false;
+        }
+        job_thread_count++;
+    }
+
+    printf("[JOBS] Пул заданий: потоков %d (+ поток тика)\n", job_thread_count);
+    return true;
+}
+
+void jobs_shutdown() {
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&sleep_lock);
+    pthread_cond_broadcast(&sleep_cond);
+    pthread_mutex_unlock(&sleep_lock);
+
+    for (int i = 0; i < job_thread_count; i++) {
+        pthread_join(job_threads[i], NULL);
+    }
+    job_thread_count = 0;
+}
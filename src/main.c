@@ -4,14 +4,22 @@
 #include <time.h>
 #include <signal.h>
 #include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
 #include <pthread.h>
 
 #include "globals.h"
 #include "server.h"
 #include "protocol.h"
+#include "network.h"
+#include "arena.h"
+#include "compress.h"
+#include "chunk_cache.h"
+#include "timer.h"
+#include "tick.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "grid.h"
+#include "tracker.h"
+#include "fluid.h"
 
 /* Глобальное состояние */
 ServerState server_state = {0};
@@ -26,141 +34,109 @@ void signal_handler(int sig) {
     }
 }
 
-/* Функция сетевого потока */
-void* network_thread_func(void* arg) {
-    struct sockaddr_in client_addr;
-    socklen_t client_addr_len = sizeof(client_addr);
-    int client_socket;
-    Player* player;
+/* Спаун и деспаун соседей у куска занятых слотов (задание пула) */
+static void track_players(void* arg, int begin, int end) {
+    (void)arg;
     
-    printf("[NETWORK] Сетевой поток запущен\n");
+    for (int i = begin; i < end; i++) {
+        tracker_update(active_player(i));
+    }
+}
+
+/* Рассылка позиций куска занятых слотов (задание пула) */
+static void broadcast_players(void* arg, int begin, int end) {
+    (void)arg;
     
-    while (server_state.running && !should_exit) {
-        /* Принимаем подключение с таймаутом */
-        client_socket = accept(server_state.server_socket, 
-                              (struct sockaddr*)&client_addr, 
-                              &client_addr_len);
-        
-        if (client_socket < 0) {
-            if (!server_state.running) break;
-            usleep(10000);  /* 10мс */
-            continue;
+    for (int i = begin; i < end; i++) {
+        Player* player = active_player(i);
+        if (player->socket > 0 && player_ready(player)) {
+            player_broadcast_position(player);
         }
-        
-        /* Проверяем лимит игроков */
-        pthread_rwlock_rdlock(&server_state.players_lock);
-        if (server_state.active_players >= MAX_PLAYERS) {
-            pthread_rwlock_unlock(&server_state.players_lock);
-            
-            const char* kick_msg = "§cСервер переполнен";
-            close(client_socket);
-            continue;
-        }
-        pthread_rwlock_unlock(&server_state.players_lock);
-        
-        /* Находим свободное место для игрока */
-        pthread_rwlock_wrlock(&server_state.players_lock);
-        for (int i = 0; i < MAX_PLAYERS; i++) {
-            if (server_state.players[i].socket == 0) {
-                player = &server_state.players[i];
-                player->socket = client_socket;
-                player->entity_id = i;
-                player->protocol_state = 0;  /* Handshake */
-                strncpy(player->ip, inet_ntoa(client_addr.sin_addr), 15);
-                player->port = ntohs(client_addr.sin_port);
-                player->health = 20;
-                player->join_time = time(NULL);
-                server_state.active_players++;
-                
-                printf("[NETWORK] Новый клиент подключился: %s:%d (ID=%d, всего=%d)\n",
-                       player->ip, player->port, player->entity_id, 
-                       server_state.active_players);
-                break;
-            }
-        }
-        pthread_rwlock_unlock(&server_state.players_lock);
     }
-    
-    printf("[NETWORK] Сетевой поток завершился\n");
-    return NULL;
 }
 
 /* Функция игрового цикла */
 void* tick_thread_func(void* arg) {
-    uint64_t last_tick = 0;
-    uint64_t tick_start, tick_end, tick_delta;
-    int lag_frames = 0;
+    (void)arg;
     
     printf("[TICK] Игровой цикл запущен (TPS=%d)\n", TICK_RATE);
+    tick_scheduler_init();
     
     while (server_state.running && !should_exit) {
-        tick_start = (uint64_t)time(NULL) * 1000 + clock() / (CLOCKS_PER_SEC / 1000);
+        tick_begin();
+        
+        /* Замер фаз: каждая закрывается prof_lap, пропущенная в этом тике не пишется */
+        uint64_t tick_start = prof_now();
+        uint64_t phase_start = tick_start;
         
         /* === ОСНОВНОЙ ИГРОВОЙ ТИК === */
         server_state.current_tick++;
         
+        /* Применяем действия игроков, принятые сетевыми потоками */
+        network_process_actions();
+        prof_lap(PROF_ACTIONS, &phase_start);
+        
+        /* Keep-alive, таймауты и отложенные задачи */
+        timer_advance(server_state.current_tick);
+        prof_lap(PROF_TIMERS, &phase_start);
+        
         /* Обновляем мобов (реже для экономии) */
         if (server_state.current_tick % MOB_AI_TICKS == 0) {
             /* Обновление AI мобов */
+            prof_lap(PROF_MOBS, &phase_start);
         }
         
         /* Обновляем редстоун (реже) */
         if (server_state.current_tick % REDSTONE_UPDATE_INTERVAL == 0) {
             /* Обновление редстоуна */
+            prof_lap(PROF_REDSTONE, &phase_start);
         }
         
-        /* Обновляем жидкости (реже) */
-        if (server_state.current_tick % FLUID_UPDATE_TICKS == 0) {
-            /* Обновление текучести */
+        /* Обновляем жидкости (реже): не больше FLUID_FLOW_LIMIT позиций,
+           остальное ждёт следующей фазы */
+        if (ENABLE_FLUIDS && server_state.current_tick % FLUID_UPDATE_TICKS == 0) {
+            fluid_tick(FLUID_FLOW_LIMIT);
+            prof_lap(PROF_FLUIDS, &phase_start);
         }
         
-        /* Обновляем сущности */
+        /* Обновляем сущности: раз в ENTITY_UPDATE_RATE - кто у кого заспавнен
+           и на каком уровне, затем каждый тик движения игроков для уровней,
+           чей такт пришёл. Кусками в пуле */
+        pthread_rwlock_rdlock(&server_state.players_lock);
         if (server_state.current_tick % ENTITY_UPDATE_RATE == 0) {
-            pthread_rwlock_rdlock(&server_state.players_lock);
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
-                    /* Обновляем позицию игрока для остальных */
-                    player_broadcast_position(&server_state.players[i]);
-                }
-            }
-            pthread_rwlock_unlock(&server_state.players_lock);
-        }
-        
-        /* Keep-alive для игроков */
-        if (server_state.current_tick % 600 == 0) {  /* каждые 30 сек */
-            pthread_rwlock_rdlock(&server_state.players_lock);
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
-                    packet_send_keep_alive(&server_state.players[i], server_state.current_tick);
-                }
-            }
-            pthread_rwlock_unlock(&server_state.players_lock);
+            jobs_parallel_for(server_state.active_players, JOB_PLAYER_GRAIN, track_players, NULL);
         }
+        jobs_parallel_for(server_state.active_players, JOB_PLAYER_GRAIN, broadcast_players, NULL);
+        pthread_rwlock_unlock(&server_state.players_lock);
+        prof_lap(PROF_ENTITIES, &phase_start);
         
         /* Периодическое сохранение мира */
         if (server_state.current_tick % (SAVE_INTERVAL / TIME_BETWEEN_TICKS) == 0) {
             server_save_world();
+            prof_lap(PROF_SAVE, &phase_start);
         }
         
-        /* === СИНХРОНИЗАЦИЯ ТИКОВ === */
-        tick_end = (uint64_t)time(NULL) * 1000 + clock() / (CLOCKS_PER_SEC / 1000);
-        tick_delta = tick_end - tick_start;
+        /* Отправляем накопленные за тик пакеты */
+        network_flush_all();
         
-        if (tick_delta < TIME_BETWEEN_TICKS) {
-            usleep((TIME_BETWEEN_TICKS - tick_delta) * 1000);
-        } else {
-            lag_frames++;
-            if (lag_frames > 5) {
-                server_state.ticks_with_lag++;
-            }
-        }
+        /* Буферы пакетов этого тика больше не нужны */
+        arena_reset();
+        prof_lap(PROF_FLUSH, &phase_start);
+        prof_lap(PROF_TICK, &tick_start);
+        profiler_tick_end();
         
         /* Логирование информации каждые 20 сек */
         if (server_state.current_tick % 400 == 0) {
-            printf("[TICK] Тик #%u | Игроков: %d | Лаг-фреймов: %d\n",
-                   server_state.current_tick, server_state.active_players, 
-                   server_state.ticks_with_lag);
+            printf("[TICK] Тик #%u | Игроков: %d | TPS: %.1f | MSPT: %.1f (макс %.1f) | пропущено: %llu\n",
+                   server_state.current_tick, server_state.active_players,
+                   server_state.tps, server_state.mspt, server_state.mspt_max,
+                   (unsigned long long)server_state.ticks_skipped);
+            profiler_report();
         }
+        
+        /* === СИНХРОНИЗАЦИЯ ТИКОВ === */
+        server_state.total_ticks++;
+        tick_end();
     }
     
     printf("[TICK] Игровой цикл завершился\n");
@@ -169,9 +145,6 @@ void* tick_thread_func(void* arg) {
 
 /* Инициализация сервера */
 bool server_init() {
-    struct sockaddr_in server_addr;
-    int opt = 1;
-    
     printf("[SERVER] Инициализация сервера...\n");
     printf("[SERVER] Максимум игроков: %d\n", MAX_PLAYERS);
     printf("[SERVER] Частота тиков: %d TPS\n", TICK_RATE);
@@ -183,41 +156,25 @@ bool server_init() {
     server_state.current_tick = 0;
     pthread_rwlock_init(&server_state.players_lock, NULL);
     pthread_rwlock_init(&server_state.chunks_lock, NULL);
+    timer_wheel_init(server_state.current_tick);
+    grid_init();
+    fluid_init();
     
-    /* Создаём сокет */
-    server_state.server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_state.server_socket < 0) {
-        perror("[ERROR] Не удалось создать сокет");
+    /* Пул сжатия пакетов */
+    if (!compress_init()) {
         return false;
     }
     
-    /* Устанавливаем опции сокета */
-    if (setsockopt(server_state.server_socket, SOL_SOCKET, SO_REUSEADDR, 
-                   &opt, sizeof(opt)) < 0) {
-        perror("[ERROR] setsockopt failed");
+    /* Пул заданий для параллельных фаз тика */
+    if (!jobs_init()) {
         return false;
     }
     
-    /* Привязываем сокет */
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(SERVER_PORT);
-    
-    if (bind(server_state.server_socket, (struct sockaddr*)&server_addr, 
-             sizeof(server_addr)) < 0) {
-        perror("[ERROR] bind failed");
+    /* Слушающие сокеты и циклы сетевых потоков */
+    if (!network_init()) {
         return false;
     }
     
-    /* Начинаем слушать */
-    if (listen(server_state.server_socket, 128) < 0) {
-        perror("[ERROR] listen failed");
-        return false;
-    }
-    
-    printf("[SERVER] Сервер слушает на порту %d\n", SERVER_PORT);
-    
     /* Инициализируем игроков */
     for (int i = 0; i < MAX_PLAYERS; i++) {
         server_state.players[i].socket = 0;
@@ -238,9 +195,12 @@ bool server_init() {
         return false;
     }
     
-    if (pthread_create(&server_state.network_thread, NULL, network_thread_func, NULL) != 0) {
-        perror("[ERROR] Не удалось создать network thread");
-        return false;
+    for (int i = 0; i < NET_THREADS; i++) {
+        if (pthread_create(&server_state.network_threads[i], NULL, network_thread_func,
+                           (void*)(intptr_t)i) != 0) {
+            perror("[ERROR] Не удалось создать network thread");
+            return false;
+        }
     }
     
     printf("[SERVER] Сервер успешно инициализирован\n");
@@ -255,9 +215,9 @@ void server_shutdown() {
     
     /* Закрываем все соединения игроков */
     pthread_rwlock_wrlock(&server_state.players_lock);
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0) {
-            close(server_state.players[i].socket);
+    for (int i = 0; i < server_state.active_players; i++) {
+        if (active_player(i)->socket > 0) {
+            close(active_player(i)->socket);
         }
     }
     pthread_rwlock_unlock(&server_state.players_lock);
@@ -265,14 +225,18 @@ void server_shutdown() {
     /* Сохраняем мир */
     server_save_world();
     
-    /* Закрываем сокет сервера */
-    if (server_state.server_socket > 0) {
-        close(server_state.server_socket);
-    }
-    
     /* Ждём потоков */
     pthread_join(server_state.tick_thread, NULL);
-    pthread_join(server_state.network_thread, NULL);
+    for (int i = 0; i < NET_THREADS; i++) {
+        pthread_join(server_state.network_threads[i], NULL);
+    }
+    
+    /* Закрываем слушающие сокеты */
+    network_shutdown();
+    jobs_shutdown();
+    compress_shutdown();
+    chunk_cache_clear();
+    protocol_status_free();
     
     /* Освобождаем память */
     if (server_state.chunks) {
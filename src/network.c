@@ -0,0 +1,1423 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "network.h"
+#include "protocol.h"
+#include "utils.h"
+#include "arena.h"
+#include "compress.h"
+#include "admission.h"
+#if NET_IO_URING
+#include <sys/utsname.h>
+#include "uring.h"
+#endif
+
+#define NET_MAX_IOV 64  /* блоков за один вызов sendmsg */
+
+/* === СОСТОЯНИЕ СЕТЕВЫХ ПОТОКОВ === */
+
+#if NET_IO_URING
+/* Метки в user_data: указатель на соединение выровнен, младшие биты свободны */
+#define URING_TAG_RECV   0
+#define URING_TAG_ACCEPT 1
+#define URING_TAG_MASK   3
+#define URING_RECV_GROUP 0
+#endif
+
+/* Заголовок действия в очереди к потоку тика; за ним идут байты пакета */
+typedef struct {
+    uint32_t slot;        /* индекс соединения (= слот игрока) */
+    uint32_t generation;  /* поколение соединения на момент приёма */
+    uint32_t len;         /* 0 - соединение заняло слот игрока (пакета нет) */
+} ActionHeader;
+
+/* Очередь игровых действий: сетевой поток дописывает в pending,
+   поток тика забирает буфер целиком, меняя его местами с drain */
+typedef struct {
+    pthread_mutex_t lock;
+    uint8_t* pending;
+    size_t pending_len;
+    uint8_t* drain;
+} ActionQueue;
+
+/* Сетевой поток: свой слушающий сокет (SO_REUSEPORT), свой цикл событий
+   и свои слоты игроков - индексы i с i % NET_THREADS == id */
+typedef struct {
+    int id;
+    int listen_fd;
+    int epoll_fd;
+
+#if NET_IO_URING
+    Uring ring;                 /* accept и recv */
+    UringBufRing recv_buffers;  /* буферы приёма, выбираемые ядром */
+#endif
+
+    int free_connections[MAX_PLAYERS / NET_THREADS + 1];
+    int free_count;
+    uint64_t next_sweep;  /* мс, следующая проверка соединений до логина */
+
+    ActionQueue actions;
+} NetWorker;
+
+static NetWorker workers[NET_THREADS];
+static NetBackend backend = NET_BACKEND_EPOLL;
+
+#if NET_IO_URING
+static Uring flush_ring;  /* поток тика: пакетная отправка очередей */
+
+static struct msghdr flush_msgs[NET_URING_ENTRIES];
+static struct iovec flush_iov[NET_URING_ENTRIES][NET_MAX_IOV];
+static Connection* flush_conns[NET_URING_ENTRIES];
+#endif
+
+/* Соединения (по одному на слот игрока) */
+static Connection connections[MAX_PLAYERS];
+
+/* Пул свободных блоков исходящих очередей (общий для всех потоков) */
+static OutBlock* block_pool = NULL;
+static int block_pool_count = 0;
+static pthread_mutex_t block_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* === ИСХОДЯЩИЕ ОЧЕРЕДИ === */
+
+static OutBlock* block_alloc() {
+    OutBlock* block = NULL;
+
+    pthread_mutex_lock(&block_pool_lock);
+    if (block_pool) {
+        block = block_pool;
+        block_pool = block->next;
+        block_pool_count--;
+    }
+    pthread_mutex_unlock(&block_pool_lock);
+
+    if (!block) {
+        block = malloc(sizeof(OutBlock));
+        if (!block) return NULL;
+    }
+
+    block->next = NULL;
+    block->len = 0;
+    block->sent = 0;
+    block->first_packet = NET_OUT_BLOCK_SIZE;
+    block->frame = NULL;
+    return block;
+}
+
+static void block_release(OutBlock* block) {
+    if (block->frame) {
+        frame_release(block->frame);
+        free(block);
+        return;
+    }
+
+    pthread_mutex_lock(&block_pool_lock);
+    if (block_pool_count < NET_OUT_BLOCK_POOL) {
+        block->next = block_pool;
+        block_pool = block;
+        block_pool_count++;
+        block = NULL;
+    }
+    pthread_mutex_unlock(&block_pool_lock);
+
+    free(block);
+}
+
+/* Память блока в очереди: блок данных целиком, у кадра - только сегмент.
+   Общие кадры (чанки) принадлежат кэшу и в лимит соединения не входят */
+static size_t block_mem(const OutBlock* block) {
+    return block->frame ? offsetof(OutBlock, data) : sizeof(OutBlock);
+}
+
+static void queue_append(OutQueue* queue, OutBlock* block) {
+    if (queue->tail) {
+        queue->tail->next = block;
+    } else {
+        queue->head = block;
+    }
+    queue->tail = block;
+    queue->mem += block_mem(block);
+}
+
+/* Освободить все блоки очереди (под out.lock) */
+static void queue_clear(OutQueue* queue) {
+    OutBlock* block = queue->head;
+    while (block) {
+        OutBlock* next = block->next;
+        block_release(block);
+        block = next;
+    }
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->bytes = 0;
+    queue->mem = 0;
+    queue->overflow = false;
+    queue->evicted = false;
+    queue->coalesce_count = 0;
+    memset(queue->coalesce, 0, sizeof(queue->coalesce));
+}
+
+/* Дописать пакет в хвост очереди (под out.lock). false - нет памяти */
+static bool queue_write(OutQueue* queue, const uint8_t* data, size_t len) {
+    bool packet_start = true;
+
+    while (len > 0) {
+        OutBlock* tail = queue->tail;
+
+        if (!tail || tail->frame || tail->len == NET_OUT_BLOCK_SIZE) {
+            OutBlock* block = block_alloc();
+            if (!block) return false;
+            queue_append(queue, block);
+            tail = block;
+        }
+
+        if (packet_start && tail->first_packet == NET_OUT_BLOCK_SIZE) {
+            tail->first_packet = tail->len;
+        }
+        packet_start = false;
+
+        size_t chunk = MIN(len, NET_OUT_BLOCK_SIZE - tail->len);
+        memcpy(tail->data + tail->len, data, chunk);
+        tail->len += chunk;
+        queue->bytes += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+/* Проверить жёсткий лимит перед постановкой пакета (под out.lock).
+   Пакет отбрасывается целиком - поток байт остаётся корректным */
+static bool queue_admit(Connection* conn, size_t mem) {
+    OutQueue* queue = &conn->out;
+
+    if (queue->overflow || queue->evicted) return false;
+
+    if (queue->mem + mem > NET_QUEUE_HARD_LIMIT) {
+        /* Отключение - в потоке тика (connection_evict): здесь out.lock занят */
+        queue->overflow = true;
+        return false;
+    }
+
+    return true;
+}
+
+/* Записать пакет в очередь (под out.lock) */
+static void queue_packet(Connection* conn, const uint8_t* data, size_t len) {
+    if (conn->fd < 0 || !queue_admit(conn, len)) return;
+
+    if (!queue_write(&conn->out, data, len)) {
+        /* Пакет записан не целиком - поток байт испорчен */
+        printf("[NETWORK] Нет памяти под очередь %s:%d\n", conn->ip, conn->port);
+        network_close(conn);
+    }
+}
+
+void network_queue(Connection* conn, const uint8_t* data, size_t len) {
+    if (!conn || !data || len == 0) return;
+
+    OutQueue* queue = &conn->out;
+    pthread_mutex_lock(&queue->lock);
+    queue_packet(conn, data, len);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static CoalesceSlot* coalesce_find(OutQueue* queue, uint64_t key) {
+    uint32_t start = (uint32_t)(key ^ (key >> 32)) * 2654435761u;
+
+    for (int i = 0; i < NET_COALESCE_SLOTS; i++) {
+        CoalesceSlot* slot = &queue->coalesce[(start + i) & (NET_COALESCE_SLOTS - 1)];
+        if (slot->key == key || slot->key == 0) return slot;
+    }
+
+    return NULL;
+}
+
+/* Отложенное обновление с ключом, если есть. Слот мог остаться после
+   частичной разгрузки за освободившимся - ищем по всей цепочке */
+static CoalesceSlot* coalesce_pending(OutQueue* queue, uint64_t key) {
+    if (queue->coalesce_count == 0) return NULL;
+
+    uint32_t start = (uint32_t)(key ^ (key >> 32)) * 2654435761u;
+
+    for (int i = 0; i < NET_COALESCE_SLOTS; i++) {
+        CoalesceSlot* slot = &queue->coalesce[(start + i) & (NET_COALESCE_SLOTS - 1)];
+        if (slot->key == key) return slot;
+    }
+
+    return NULL;
+}
+
+void network_queue_keyed(Connection* conn, uint64_t key, const uint8_t* data, size_t len) {
+    if (!conn || !data || len == 0) return;
+
+    OutQueue* queue = &conn->out;
+    pthread_mutex_lock(&queue->lock);
+
+    CoalesceSlot* pending = coalesce_pending(queue, key);
+
+    /* Клиент успевает - обычный путь. Отложенный снимок с тем же ключом
+       устарел и не должен прийти после этого */
+    if ((queue->bytes < NET_QUEUE_SOFT_LIMIT && !pending) ||
+        len > NET_COALESCE_MAX_PACKET || conn->fd < 0) {
+        if (pending) {
+            pending->key = 0;
+            queue->coalesce_count--;
+        }
+        queue_packet(conn, data, len);
+        pthread_mutex_unlock(&queue->lock);
+        return;
+    }
+
+    CoalesceSlot* slot = pending ? pending : coalesce_find(queue, key);
+    if (!slot) {
+        /* Таблица заполнена - пусть решает жёсткий лимит */
+        queue_packet(conn, data, len);
+        pthread_mutex_unlock(&queue->lock);
+        return;
+    }
+
+    /* Более раннее обновление с тем же ключом просто перезаписывается */
+    if (slot->key == 0) queue->coalesce_count++;
+    slot->key = key;
+    slot->len = (uint16_t)len;
+    memcpy(slot->data, data, len);
+
+    pthread_mutex_unlock(&queue->lock);
+}
+
+bool network_queue_delta(Connection* conn, uint64_t key, const uint8_t* data, size_t len) {
+    if (!conn || !data || len == 0) return true;
+
+    OutQueue* queue = &conn->out;
+    pthread_mutex_lock(&queue->lock);
+
+    /* Дельта к отложенному снимку или в забитую очередь потеряла бы базу */
+    bool deferred = conn->fd >= 0 &&
+                    (queue->bytes >= NET_QUEUE_SOFT_LIMIT || coalesce_pending(queue, key));
+    if (!deferred) {
+        queue_packet(conn, data, len);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+    return !deferred;
+}
+
+/* Очередь разгрузилась - отложенные обновления уходят в хвост (под out.lock) */
+static void queue_drain_coalesced(OutQueue* queue) {
+    if (queue->coalesce_count == 0 || queue->bytes >= NET_QUEUE_SOFT_LIMIT) return;
+
+    for (int i = 0; i < NET_COALESCE_SLOTS; i++) {
+        CoalesceSlot* slot = &queue->coalesce[i];
+        if (slot->key == 0) continue;
+
+        if (!queue_write(queue, slot->data, slot->len)) break;
+        slot->key = 0;
+        queue->coalesce_count--;
+    }
+}
+
+void network_queue_frame(Connection* conn, Frame* frame) {
+    if (!conn || !frame) return;
+
+    /* Мелкий готовый кадр дешевле скопировать, чем держать отдельным сегментом */
+    if (frame_is_ready(frame) && frame->len <= NET_FRAME_COPY_MAX) {
+        network_queue(conn, frame->data, frame->len);
+        return;
+    }
+
+    OutBlock* block = malloc(offsetof(OutBlock, data));
+    if (!block) {
+        printf("[NETWORK] Нет памяти под очередь %s:%d\n", conn->ip, conn->port);
+        network_close(conn);
+        return;
+    }
+
+    block->next = NULL;
+    block->len = 0;
+    block->sent = 0;
+    block->first_packet = 0;
+    block->frame = frame;
+    frame_retain(frame);
+
+    OutQueue* queue = &conn->out;
+    pthread_mutex_lock(&queue->lock);
+
+    if (conn->fd < 0 || !queue_admit(conn, block_mem(block))) {
+        pthread_mutex_unlock(&queue->lock);
+        block_release(block);
+        return;
+    }
+
+    queue_append(queue, block);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/* Собрать iovec по неотправленным данным (под out.lock).
+   Останавливается на кадре, который ещё сжимается: порядок пакетов важнее.
+   -1 - в голове очереди кадр, который сжать не удалось */
+static int queue_gather(OutQueue* queue, struct iovec* iov, int max_iov, size_t* total) {
+    int count = 0;
+    *total = 0;
+
+    queue_drain_coalesced(queue);
+
+    for (OutBlock* block = queue->head; block && count < max_iov; block = block->next) {
+        const uint8_t* data = block->data;
+
+        if (block->frame) {
+            if (block->len == 0) {
+                if (!frame_is_ready(block->frame)) {
+                    if (count == 0 && frame_is_failed(block->frame)) return -1;
+                    break;
+                }
+                block->len = block->frame->len;
+                queue->bytes += block->len;
+            }
+            data = block->frame->data;
+        }
+
+        iov[count].iov_base = (uint8_t*)data + block->sent;
+        iov[count].iov_len = block->len - block->sent;
+        *total += iov[count].iov_len;
+        count++;
+    }
+
+    return count;
+}
+
+/* Снять отправленные байты с головы очереди (под out.lock).
+   Хвост мог дополниться после queue_gather - считаем по байтам, не по блокам */
+static void queue_consume(OutQueue* queue, size_t sent) {
+    queue->bytes -= sent;
+
+    while (sent > 0) {
+        OutBlock* block = queue->head;
+        size_t avail = block->len - block->sent;
+
+        if (sent < avail) {
+            block->sent += sent;
+            break;
+        }
+
+        sent -= avail;
+        queue->head = block->next;
+        queue->mem -= block_mem(block);
+        block_release(block);
+    }
+
+    if (!queue->head) queue->tail = NULL;
+}
+
+/* Обрезать очередь по границе пакета (под out.lock): начатый пакет
+   дописывается, всё после него выбрасывается */
+static void queue_trim(OutQueue* queue) {
+    OutBlock* keep = queue->head;
+    if (!keep) return;
+
+    if (!keep->frame && keep->first_packet > keep->sent && keep->first_packet < keep->len) {
+        /* До first_packet - хвост уже начатого пакета */
+        keep->len = keep->first_packet;
+    } else {
+        while (keep->next && !keep->next->frame) {
+            OutBlock* next = keep->next;
+            if (next->first_packet < next->len) {
+                if (next->first_packet > 0) {
+                    next->len = next->first_packet;
+                    keep = next;
+                }
+                break;
+            }
+            keep = next;
+        }
+    }
+
+    OutBlock* block = keep->next;
+    while (block) {
+        OutBlock* next = block->next;
+        block_release(block);
+        block = next;
+    }
+    keep->next = NULL;
+    queue->tail = keep;
+
+    queue->bytes = 0;
+    queue->mem = 0;
+    for (block = queue->head; block; block = block->next) {
+        queue->bytes += block->len - block->sent;
+        queue->mem += block_mem(block);
+    }
+
+    queue->coalesce_count = 0;
+    memset(queue->coalesce, 0, sizeof(queue->coalesce));
+}
+
+/* Клиент не успевает читать: очередь превысила NET_QUEUE_HARD_LIMIT.
+   Вызывается из потока тика под players_lock на чтение */
+static void connection_evict(Player* player, Connection* conn) {
+    pthread_mutex_lock(&conn->out.lock);
+    queue_trim(&conn->out);
+    conn->out.overflow = false;
+    pthread_mutex_unlock(&conn->out.lock);
+
+    printf("[NETWORK] %s (%s:%d) не успевает принимать данные - отключение\n",
+           player->username, conn->ip, conn->port);
+
+    packet_send_disconnect(player, "Слишком медленное соединение");
+    network_flush(conn);
+
+    /* До удаления игрока в очередь больше ничего не попадает */
+    pthread_mutex_lock(&conn->out.lock);
+    conn->out.evicted = true;
+    pthread_mutex_unlock(&conn->out.lock);
+
+    network_close(conn);
+}
+
+static void set_tcp_cork(int fd, int value) {
+    setsockopt(fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+}
+
+void network_flush(Connection* conn) {
+    if (!conn) return;
+
+    OutQueue* queue = &conn->out;
+    pthread_mutex_lock(&queue->lock);
+
+    bool corked = false;
+
+    while (queue->head && conn->fd >= 0) {
+        struct iovec iov[NET_MAX_IOV];
+        size_t total = 0;
+        int count = queue_gather(queue, iov, NET_MAX_IOV, &total);
+        if (count < 0) {
+            network_close(conn);
+            break;
+        }
+        if (count == 0) break;  /* впереди кадр, который ещё сжимается */
+
+        /* Очередь не влезла в один вызов - склеиваем сегменты через TCP_CORK */
+        if (!corked && count == NET_MAX_IOV) {
+            set_tcp_cork(conn->fd, 1);
+            corked = true;
+        }
+
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = (size_t)count };
+        ssize_t sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                network_close(conn);
+            }
+            break;
+        }
+
+        queue_consume(queue, (size_t)sent);
+
+        /* Буфер сокета заполнен - остаток в следующем тике */
+        if ((size_t)sent < total) break;
+    }
+
+    if (corked) {
+        set_tcp_cork(conn->fd, 0);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+}
+
+#if NET_IO_URING
+/* Дождаться завершения пачки sendmsg и снять отправленное с очередей */
+static void uring_flush_reap(int count) {
+    if (count == 0) return;
+
+    int ret = uring_submit_and_wait(&flush_ring, (unsigned)count, -1);
+    if (ret < 0) {
+        printf("[NETWORK] io_uring_enter: %s\n", strerror(-ret));
+    }
+
+    struct io_uring_cqe* cqe;
+    while ((cqe = uring_peek_cqe(&flush_ring))) {
+        Connection* conn = flush_conns[cqe->user_data];
+        int res = cqe->res;
+        uring_cqe_seen(&flush_ring);
+
+        if (res > 0) {
+            pthread_mutex_lock(&conn->out.lock);
+            queue_consume(&conn->out, (size_t)res);
+            pthread_mutex_unlock(&conn->out.lock);
+        } else if (res < 0 && res != -EAGAIN && res != -EINTR) {
+            network_close(conn);
+        }
+    }
+}
+
+/* Все очереди уходят пачками по NET_URING_ENTRIES sendmsg на один системный вызов.
+   Блоки не освобождаются, пока идёт отправка: соединение освобождается только
+   после remove_player, а он ждёт players_lock на запись */
+static void uring_flush_all() {
+    int count = 0;
+
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* player = active_player(i);
+        Connection* conn = player->conn;
+        if (player->socket <= 0 || !conn) continue;
+
+        if (conn->out.evicted) continue;
+        if (conn->out.overflow) {
+            connection_evict(player, conn);
+            continue;
+        }
+
+        size_t total = 0;
+        pthread_mutex_lock(&conn->out.lock);
+        int iov_count = conn->fd >= 0 ?
+            queue_gather(&conn->out, flush_iov[count], NET_MAX_IOV, &total) : 0;
+        pthread_mutex_unlock(&conn->out.lock);
+        if (iov_count < 0) {
+            network_close(conn);
+            continue;
+        }
+        if (iov_count == 0) continue;
+
+        struct io_uring_sqe* sqe = uring_get_sqe(&flush_ring);
+        if (!sqe) {
+            uring_flush_reap(count);
+            count = 0;
+            i--;  /* повторить это соединение с пустой очередью SQ */
+            continue;
+        }
+
+        flush_msgs[count] = (struct msghdr){
+            .msg_iov = flush_iov[count],
+            .msg_iovlen = (size_t)iov_count
+        };
+        flush_conns[count] = conn;
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = conn->fd;
+        sqe->addr = (uint64_t)(uintptr_t)&flush_msgs[count];
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+        sqe->user_data = (uint64_t)count;
+        count++;
+    }
+
+    uring_flush_reap(count);
+}
+#endif
+
+void network_flush_all() {
+    pthread_rwlock_rdlock(&server_state.players_lock);
+
+#if NET_IO_URING
+    if (backend == NET_BACKEND_IO_URING) {
+        uring_flush_all();
+        pthread_rwlock_unlock(&server_state.players_lock);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* player = active_player(i);
+        if (player->socket <= 0 || !player->conn) continue;
+
+        if (player->conn->out.evicted) continue;
+
+        if (player->conn->out.overflow) {
+            connection_evict(player, player->conn);
+        } else {
+            network_flush(player->conn);
+        }
+    }
+
+    pthread_rwlock_unlock(&server_state.players_lock);
+}
+
+/* === ПУЛ СОЕДИНЕНИЙ === */
+
+static NetWorker* connection_worker(Connection* conn) {
+    return &workers[(conn - connections) % NET_THREADS];
+}
+
+static Connection* connection_alloc(NetWorker* worker) {
+    if (worker->free_count == 0) return NULL;
+
+    Connection* conn = &connections[worker->free_connections[--worker->free_count]];
+    conn->fd = -1;
+    conn->player = NULL;
+    conn->recv_len = 0;
+    conn->closing = false;
+    conn->state = PROTOCOL_STATE_HANDSHAKE;
+    conn->half_open = false;
+    return conn;
+}
+
+static void connection_free(Connection* conn) {
+    NetWorker* worker = connection_worker(conn);
+
+    pthread_mutex_lock(&conn->out.lock);
+    queue_clear(&conn->out);
+    conn->fd = -1;
+    pthread_mutex_unlock(&conn->out.lock);
+
+    conn->player = NULL;
+    worker->free_connections[worker->free_count++] = (int)(conn - connections);
+}
+
+/* Закрыть соединение и освободить слот игрока */
+static void connection_release(Connection* conn) {
+    if (conn->half_open) {
+        conn->half_open = false;
+        admission_release();
+    }
+
+    if (backend == NET_BACKEND_EPOLL) {
+        epoll_ctl(connection_worker(conn)->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    }
+
+    if (conn->player) {
+        remove_player(conn->player);  /* закрывает сокет, отвязывает conn */
+    } else {
+        close(conn->fd);
+    }
+
+    connection_free(conn);
+}
+
+/* Занять слот игрока, закреплённый за соединением (пришёл Login Start) */
+static Player* assign_player_slot(Connection* conn) {
+    int slot = (int)(conn - connections);
+    Player* player = &server_state.players[slot];
+
+    pthread_rwlock_wrlock(&server_state.players_lock);
+
+    memset(player, 0, sizeof(Player));
+    player->socket = conn->fd;
+    player->conn = conn;
+    player->entity_id = slot;
+    player->protocol_state = PROTOCOL_STATE_LOGIN;
+    memcpy(player->ip, conn->ip, sizeof(player->ip));
+    player->port = conn->port;
+    player->health = 20;
+    player->join_time = time(NULL);
+    conn->generation++;  /* старые действия этого слота больше не применяются */
+    player_hot_reset(player);
+    players_index_add(player);
+
+    printf("[NETWORK] Новый клиент подключился: %s:%d (ID=%d, поток=%d, всего=%d)\n",
+           player->ip, player->port, player->entity_id, slot % NET_THREADS,
+           server_state.active_players);
+
+    pthread_rwlock_unlock(&server_state.players_lock);
+
+    return player;
+}
+
+void network_close(Connection* conn) {
+    if (!conn || conn->fd < 0) return;
+
+    /* Сетевой поток получит EPOLLHUP (или последний CQE recv) и освободит соединение сам */
+    shutdown(conn->fd, SHUT_RDWR);
+}
+
+/* === ОЧЕРЕДЬ ДЕЙСТВИЙ === */
+
+static bool action_queue_init(ActionQueue* queue) {
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->pending = malloc(NET_ACTION_QUEUE_SIZE);
+    queue->drain = malloc(NET_ACTION_QUEUE_SIZE);
+    queue->pending_len = 0;
+    return queue->pending && queue->drain;
+}
+
+static void action_queue_free(ActionQueue* queue) {
+    free(queue->pending);
+    free(queue->drain);
+    queue->pending = NULL;
+    queue->drain = NULL;
+    pthread_mutex_destroy(&queue->lock);
+}
+
+/* Передать пакет игрового состояния потоку тика (копия кадра).
+   false - очередь переполнена */
+static bool action_push(NetWorker* worker, Connection* conn,
+                        const uint8_t* data, size_t len) {
+    ActionQueue* queue = &worker->actions;
+    ActionHeader header = {
+        .slot = (uint32_t)(conn - connections),
+        .generation = conn->generation,
+        .len = (uint32_t)len
+    };
+
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->pending_len + sizeof(header) + len > NET_ACTION_QUEUE_SIZE) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+
+    memcpy(queue->pending + queue->pending_len, &header, sizeof(header));
+    if (len > 0) memcpy(queue->pending + queue->pending_len + sizeof(header), data, len);
+    queue->pending_len += sizeof(header) + len;
+
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+void network_process_actions() {
+    pthread_rwlock_rdlock(&server_state.players_lock);
+
+    for (int w = 0; w < NET_THREADS; w++) {
+        ActionQueue* queue = &workers[w].actions;
+        if (!queue->pending) continue;
+
+        /* Забираем накопленное целиком, сетевой поток пишет в освободившийся буфер */
+        pthread_mutex_lock(&queue->lock);
+        uint8_t* data = queue->pending;
+        size_t len = queue->pending_len;
+        queue->pending = queue->drain;
+        queue->pending_len = 0;
+        queue->drain = data;
+        pthread_mutex_unlock(&queue->lock);
+
+        size_t offset = 0;
+        while (offset < len) {
+            ActionHeader header;
+            memcpy(&header, data + offset, sizeof(header));
+            offset += sizeof(header);
+
+            /* Соединение могло закрыться, а слот - достаться новому клиенту */
+            Connection* conn = &connections[header.slot];
+            Player* player = &server_state.players[header.slot];
+
+            if (player->conn == conn && conn->generation == header.generation) {
+                PacketReader frame;
+                reader_init(&frame, data + offset, header.len);
+
+                if (header.len == 0) {
+                    player_session_start(player);
+                } else if (!protocol_handle_packet(player, &frame)) {
+                    printf("[NETWORK] Ошибка протокола от %s:%d\n", player->ip, player->port);
+                    network_close(conn);
+                } else {
+                    player_session_touch(player);
+                }
+            }
+
+            offset += header.len;
+        }
+    }
+
+    pthread_rwlock_unlock(&server_state.players_lock);
+}
+
+/* === РАЗБОР ПАКЕТОВ === */
+
+/* Декодировать VarInt длины пакета.
+   Возвращает число байт заголовка, 0 - данных не хватает, -1 - ошибка */
+static int decode_frame_length(const uint8_t* data, size_t avail, int32_t* out_len) {
+    int32_t value = 0;
+
+    /* Длина пакета - не более 3 байт VarInt (2^21 - 1) */
+    for (int i = 0; i < 3; i++) {
+        if ((size_t)i >= avail) return 0;
+
+        uint8_t byte = data[i];
+        value |= (int32_t)(byte & 0x7F) << (7 * i);
+
+        if ((byte & 0x80) == 0) {
+            *out_len = value;
+            return i + 1;
+        }
+    }
+
+    return -1;
+}
+
+/* Снять обёртку сжатия: Data Length и (если он не 0) deflate.
+   Возвращает тело пакета (ID + данные) или NULL при ошибке */
+static const uint8_t* frame_unwrap_compressed(const uint8_t* data, size_t* len,
+                                              uint8_t* inflated) {
+    int32_t data_length = 0;
+    int header = decode_frame_length(data, *len, &data_length);
+    if (header <= 0) return NULL;
+
+    /* Тело меньше порога пришло как есть */
+    if (data_length == 0) {
+        *len -= (size_t)header;
+        return data + header;
+    }
+
+    /* Распакованный пакет тоже должен влезать в приёмный буфер */
+    if (data_length > NET_RECV_BUFFER_SIZE) return NULL;
+
+    if (!compress_inflate(data + header, *len - (size_t)header,
+                          inflated, (size_t)data_length)) {
+        return NULL;
+    }
+
+    *len = (size_t)data_length;
+    return inflated;
+}
+
+/* Разобрать все целые пакеты в приёмном буфере.
+   false - соединение нужно закрыть */
+static bool connection_process_frames(Connection* conn) {
+    uint8_t inflated[NET_RECV_BUFFER_SIZE];
+    size_t offset = 0;
+
+    /* Старый пинг списка серверов (до 1.7): 0xFE вместо длины пакета */
+    if (!conn->player && conn->state == PROTOCOL_STATE_HANDSHAKE &&
+        conn->recv_len > 0 && conn->recv_buf[0] == 0xFE) {
+        protocol_send_legacy_status(conn);
+        conn->recv_len = 0;
+        return true;
+    }
+
+    while (offset < conn->recv_len) {
+        int32_t frame_len = 0;
+        int header = decode_frame_length(conn->recv_buf + offset,
+                                         conn->recv_len - offset, &frame_len);
+        if (header < 0) return false;
+        if (header == 0) break;
+
+        if (frame_len <= 0 || frame_len > NET_RECV_BUFFER_SIZE - header) {
+            return false;  /* пустой или не влезающий в буфер пакет */
+        }
+        if (offset + header + frame_len > conn->recv_len) break;
+
+        const uint8_t* data = conn->recv_buf + offset + header;
+        size_t data_len = (size_t)frame_len;
+
+        if (conn->player && conn->player->compression) {
+            data = frame_unwrap_compressed(data, &data_len, inflated);
+            if (!data) {
+                printf("[NETWORK] Повреждённый сжатый пакет от %s:%d\n", conn->ip, conn->port);
+                return false;
+            }
+        }
+
+        PacketReader frame;
+        reader_init(&frame, data, data_len);
+
+        if (!conn->player && conn->state == PROTOCOL_STATE_LOGIN) {
+            /* Слот игрока - только под целый Login Start: до него соединение
+               остаётся недооткрытым, под лимитом и таймаутом admission */
+            if (!protocol_login_start_valid(&frame)) return false;
+            conn->half_open = false;
+            admission_release();
+            conn->player = assign_player_slot(conn);
+
+            /* Login - прямо здесь, без копирования */
+            if (!protocol_handle_packet(conn->player, &frame)) return false;
+
+            /* Keep-alive, таймаут и вход в мир заводит поток тика */
+            if (!action_push(connection_worker(conn), conn, NULL, 0)) return false;
+        } else if (!conn->player) {
+            /* Handshake и status - без слота игрока, ответ уходит сразу */
+            if (!protocol_handle_connection_packet(conn, &frame)) {
+                return false;
+            }
+        } else {
+            /* Игровые действия меняют мир - их применяет поток тика */
+            if (!action_push(connection_worker(conn), conn, data, data_len)) {
+                printf("[NETWORK] Очередь действий переполнена, отключаем %s:%d\n",
+                       conn->ip, conn->port);
+                return false;
+            }
+        }
+
+        offset += header + frame_len;
+    }
+
+    /* Сдвигаем недочитанный хвост в начало буфера */
+    if (offset > 0) {
+        conn->recv_len -= offset;
+        memmove(conn->recv_buf, conn->recv_buf + offset, conn->recv_len);
+    }
+
+    return true;
+}
+
+/* Вычитать сокет до EAGAIN (edge-triggered) */
+static void connection_read(Connection* conn) {
+    for (;;) {
+        size_t space = sizeof(conn->recv_buf) - conn->recv_len;
+        ssize_t n = recv(conn->fd, conn->recv_buf + conn->recv_len, space, 0);
+
+        if (n > 0) {
+            conn->recv_len += (size_t)n;
+            if (!connection_process_frames(conn)) {
+                connection_release(conn);
+                return;
+            }
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+        /* n == 0 (клиент закрыл соединение) или ошибка сокета */
+        connection_release(conn);
+        return;
+    }
+}
+
+/* === ПРИЁМ ПОДКЛЮЧЕНИЙ === */
+
+#if NET_IO_URING
+/* Следующий SQE кольца потока; если очередь полна - сначала отправляем её */
+static struct io_uring_sqe* worker_sqe(NetWorker* worker) {
+    struct io_uring_sqe* sqe = uring_get_sqe(&worker->ring);
+    if (!sqe) {
+        uring_submit_and_wait(&worker->ring, 0, 0);
+        sqe = uring_get_sqe(&worker->ring);
+    }
+    return sqe;
+}
+
+static void uring_arm_accept(NetWorker* worker) {
+    struct io_uring_sqe* sqe = worker_sqe(worker);
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = worker->listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = URING_TAG_ACCEPT;
+}
+
+/* Multishot recv: ядро само берёт буфер из recv_buffers на каждую порцию данных */
+static bool uring_arm_recv(Connection* conn) {
+    NetWorker* worker = connection_worker(conn);
+    struct io_uring_sqe* sqe = worker_sqe(worker);
+    if (!sqe) return false;
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_RECV_GROUP;
+    sqe->user_data = (uint64_t)(uintptr_t)conn | URING_TAG_RECV;
+    return true;
+}
+#endif
+
+/* Зарегистрировать принятый сокет: соединение и чтение (слот игрока - при Login Start) */
+static void connection_open(NetWorker* worker, int fd, const struct sockaddr_in* client_addr) {
+    uint64_t now = get_millis();
+
+    /* Флуд отсекается до выделения соединения */
+    if (!admission_try_open(client_addr->sin_addr.s_addr, now)) {
+        close(fd);
+        return;
+    }
+
+    Connection* conn = connection_alloc(worker);
+    if (!conn) {
+        /* Слоты этого потока заняты */
+        admission_release();
+        close(fd);
+        return;
+    }
+
+    conn->fd = fd;
+    conn->half_open = true;
+    conn->opened_at = now;
+
+    /* Очереди сбрасываются раз в тик - Nagle только добавил бы задержку */
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    inet_ntop(AF_INET, &client_addr->sin_addr, conn->ip, sizeof(conn->ip));
+    conn->port = ntohs(client_addr->sin_port);
+
+#if NET_IO_URING
+    if (backend == NET_BACKEND_IO_URING) {
+        if (!uring_arm_recv(conn)) connection_release(conn);
+        return;
+    }
+#endif
+
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLRDHUP | EPOLLET,
+        .data.ptr = conn
+    };
+    if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("[NETWORK] epoll_ctl failed");
+        connection_release(conn);
+    }
+}
+
+static void accept_clients(NetWorker* worker) {
+    for (;;) {
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+
+        int fd = accept4(worker->listen_fd,
+                         (struct sockaddr*)&client_addr, &client_addr_len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("[NETWORK] accept failed");
+            }
+            return;
+        }
+
+        connection_open(worker, fd, &client_addr);
+    }
+}
+
+/* Закрыть соединения, не дошедшие до логина за ADMISSION_HANDSHAKE_TIMEOUT.
+   Раз в секунду, только свои слоты - без блокировок */
+static void connection_sweep(NetWorker* worker) {
+    uint64_t now = get_millis();
+    if (now < worker->next_sweep) return;
+    worker->next_sweep = now + 1000;
+
+    for (int i = worker->id; i < MAX_PLAYERS; i += NET_THREADS) {
+        Connection* conn = &connections[i];
+        if (conn->fd >= 0 && conn->half_open &&
+            now - conn->opened_at > ADMISSION_HANDSHAKE_TIMEOUT) {
+            network_close(conn);
+        }
+    }
+
+    uint32_t rejected = admission_take_rejected();
+    if (rejected > 0) {
+        printf("[NETWORK] Отклонено подключений: %u (лимит по IP или до логина)\n", rejected);
+    }
+}
+
+/* === БЭКЕНД IO_URING === */
+
+#if NET_IO_URING
+static void uring_backend_free() {
+    for (int i = 0; i < NET_THREADS; i++) {
+        NetWorker* worker = &workers[i];
+        if (worker->ring.fd < 0) continue;
+        uring_buf_ring_free(&worker->ring, &worker->recv_buffers);
+        uring_exit(&worker->ring);
+    }
+    if (flush_ring.fd >= 0) uring_exit(&flush_ring);
+}
+
+static bool uring_backend_init() {
+    /* Multishot recv с кольцом буферов - Linux 6.0+ */
+    struct utsname uts;
+    int major = 0, minor = 0;
+    if (uname(&uts) != 0 || sscanf(uts.release, "%d.%d", &major, &minor) != 2 ||
+        major < 6) {
+        return false;
+    }
+
+    flush_ring.fd = -1;
+    for (int i = 0; i < NET_THREADS; i++) {
+        workers[i].ring.fd = -1;
+    }
+
+    if (!uring_init(&flush_ring, NET_URING_ENTRIES) ||
+        !uring_probe_op(&flush_ring, IORING_OP_ACCEPT) ||
+        !uring_probe_op(&flush_ring, IORING_OP_RECV) ||
+        !uring_probe_op(&flush_ring, IORING_OP_SENDMSG)) {
+        uring_backend_free();
+        return false;
+    }
+
+    for (int i = 0; i < NET_THREADS; i++) {
+        NetWorker* worker = &workers[i];
+        if (!uring_init(&worker->ring, NET_URING_ENTRIES) ||
+            !uring_buf_ring_init(&worker->ring, &worker->recv_buffers, URING_RECV_GROUP,
+                                 NET_URING_RECV_BUFFERS, NET_URING_RECV_BUFFER_SIZE)) {
+            uring_backend_free();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Порция данных или завершение multishot recv */
+static void uring_handle_recv(NetWorker* worker, Connection* conn, int res, unsigned flags) {
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+        if (res > 0 && !conn->closing) {
+            size_t space = sizeof(conn->recv_buf) - conn->recv_len;
+
+            if ((size_t)res > space) {
+                conn->closing = true;  /* пакет не влезает в приёмный буфер */
+            } else {
+                memcpy(conn->recv_buf + conn->recv_len,
+                       uring_buf_ring_get(&worker->recv_buffers, bid), (size_t)res);
+                conn->recv_len += (size_t)res;
+                if (!connection_process_frames(conn)) conn->closing = true;
+            }
+
+            /* Финальный CQE придёт после shutdown */
+            if (conn->closing) shutdown(conn->fd, SHUT_RDWR);
+        }
+
+        uring_buf_ring_recycle(&worker->recv_buffers, bid);
+    }
+
+    /* Multishot ещё активен - соединение живо */
+    if (flags & IORING_CQE_F_MORE) return;
+
+    /* Кончились буферы приёма - перевзводим чтение */
+    if (res == -ENOBUFS && !conn->closing && uring_arm_recv(conn)) return;
+
+    /* EOF, ошибка или shutdown: запросов на соединение больше нет */
+    connection_release(conn);
+}
+
+static void uring_network_loop(NetWorker* worker) {
+    uring_arm_accept(worker);
+
+    while (server_state.running) {
+        int ret = uring_submit_and_wait(&worker->ring, 1, NET_POLL_TIMEOUT);
+        if (ret < 0) {
+            printf("[NETWORK] io_uring_enter: %s\n", strerror(-ret));
+            break;
+        }
+
+        struct io_uring_cqe* cqe;
+        while ((cqe = uring_peek_cqe(&worker->ring))) {
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+            unsigned flags = cqe->flags;
+            uring_cqe_seen(&worker->ring);
+
+            if ((user_data & URING_TAG_MASK) == URING_TAG_ACCEPT) {
+                if (res >= 0) {
+                    struct sockaddr_in client_addr;
+                    socklen_t client_addr_len = sizeof(client_addr);
+                    memset(&client_addr, 0, sizeof(client_addr));
+                    getpeername(res, (struct sockaddr*)&client_addr, &client_addr_len);
+                    connection_open(worker, res, &client_addr);
+                }
+                if (!(flags & IORING_CQE_F_MORE)) uring_arm_accept(worker);
+                continue;
+            }
+
+            Connection* conn = (Connection*)(uintptr_t)(user_data & ~(uint64_t)URING_TAG_MASK);
+            uring_handle_recv(worker, conn, res, flags);
+        }
+
+        connection_sweep(worker);
+        arena_reset();
+    }
+}
+#endif
+
+/* === ИНИЦИАЛИЗАЦИЯ === */
+
+/* Слушающий сокет потока. SO_REUSEPORT: ядро распределяет входящие
+   подключения между сокетами всех сетевых потоков */
+static int create_listener() {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("[ERROR] Не удалось создать сокет");
+        return -1;
+    }
+
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        perror("[ERROR] setsockopt failed");
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(SERVER_PORT);
+
+    if (bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        perror("[ERROR] bind failed");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, 128) < 0) {
+        perror("[ERROR] listen failed");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool network_select_backend(NetBackend requested) {
+    if (requested == NET_BACKEND_EPOLL) {
+        backend = NET_BACKEND_EPOLL;
+        return true;
+    }
+
+#if NET_IO_URING
+    if (backend == NET_BACKEND_IO_URING) return true;
+    if (uring_backend_init()) {
+        backend = NET_BACKEND_IO_URING;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+NetBackend network_backend() {
+    return backend;
+}
+
+bool network_init() {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        connections[i].fd = -1;
+        connections[i].generation = 0;
+        pthread_mutex_init(&connections[i].out.lock, NULL);
+    }
+
+    for (int w = 0; w < NET_THREADS; w++) {
+        NetWorker* worker = &workers[w];
+        worker->id = w;
+        worker->listen_fd = -1;
+        worker->epoll_fd = -1;
+
+        /* Слоты потока раздаются с младших индексов */
+        worker->free_count = 0;
+        for (int i = MAX_PLAYERS - 1; i >= 0; i--) {
+            if (i % NET_THREADS == w) {
+                worker->free_connections[worker->free_count++] = i;
+            }
+        }
+
+        if (!action_queue_init(&worker->actions)) {
+            printf("[ERROR] Не удалось выделить очередь действий\n");
+            return false;
+        }
+
+        worker->listen_fd = create_listener();
+        if (worker->listen_fd < 0) return false;
+    }
+
+    printf("[SERVER] Сервер слушает на порту %d (сетевых потоков: %d)\n",
+           SERVER_PORT, NET_THREADS);
+
+#if NET_IO_URING
+    if (network_select_backend(NET_BACKEND_IO_URING)) {
+        printf("[NETWORK] Бэкенд: io_uring\n");
+        return true;
+    }
+    printf("[NETWORK] io_uring недоступен в этом ядре, откат на epoll\n");
+#endif
+
+    backend = NET_BACKEND_EPOLL;
+
+    for (int w = 0; w < NET_THREADS; w++) {
+        NetWorker* worker = &workers[w];
+
+        worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (worker->epoll_fd < 0) {
+            perror("[ERROR] epoll_create1 failed");
+            return false;
+        }
+
+        /* Событие слушающего сокета помечаем data.ptr = NULL */
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLET, .data.ptr = NULL };
+        if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->listen_fd, &ev) < 0) {
+            perror("[ERROR] epoll_ctl failed");
+            return false;
+        }
+    }
+
+    printf("[NETWORK] Бэкенд: epoll\n");
+    return true;
+}
+
+void network_shutdown() {
+#if NET_IO_URING
+    if (backend == NET_BACKEND_IO_URING) {
+        uring_backend_free();
+        backend = NET_BACKEND_EPOLL;
+    }
+#endif
+
+    for (int w = 0; w < NET_THREADS; w++) {
+        NetWorker* worker = &workers[w];
+
+        if (worker->epoll_fd >= 0) {
+            close(worker->epoll_fd);
+            worker->epoll_fd = -1;
+        }
+        if (worker->listen_fd >= 0) {
+            close(worker->listen_fd);
+            worker->listen_fd = -1;
+        }
+        if (worker->actions.pending) {
+            action_queue_free(&worker->actions);
+        }
+    }
+}
+
+/* === СЕТЕВОЙ ПОТОК === */
+
+static void epoll_network_loop(NetWorker* worker) {
+    struct epoll_event events[NET_MAX_EVENTS];
+
+    while (server_state.running) {
+        int count = epoll_wait(worker->epoll_fd, events, NET_MAX_EVENTS, NET_POLL_TIMEOUT);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("[NETWORK] epoll_wait failed");
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            Connection* conn = events[i].data.ptr;
+
+            if (!conn) {
+                accept_clients(worker);
+            } else if (conn->fd >= 0) {
+                connection_read(conn);
+            }
+        }
+
+        connection_sweep(worker);
+
+        /* Пакеты, собранные обработчиками, уже скопированы в очереди */
+        arena_reset();
+    }
+}
+
+void* network_thread_func(void* arg) {
+    NetWorker* worker = &workers[(intptr_t)arg];
+
+    printf("[NETWORK] Сетевой поток %d запущен\n", worker->id);
+
+#if NET_IO_URING
+    if (backend == NET_BACKEND_IO_URING) {
+        uring_network_loop(worker);
+    } else {
+        epoll_network_loop(worker);
+    }
+#else
+    epoll_network_loop(worker);
+#endif
+
+    printf("[NETWORK] Сетевой поток %d завершился\n", worker->id);
+    return NULL;
+}
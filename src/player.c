@@ -4,6 +4,11 @@
 #include <time.h>
 #include "server.h"
 #include "protocol.h"
+#include "network.h"
+#include "timer.h"
+#include "utils.h"
+#include "grid.h"
+#include "tracker.h"
 
 /* Создать игрока */
 Player* player_create(const char* username, const uint8_t* uuid) {
@@ -17,13 +22,6 @@ Player* player_create(const char* username, const uint8_t* uuid) {
         memcpy(player->uuid, uuid, 16);
     }
     
-    /* Спаун позиция */
-    player->x = SPAWN_X + 0.5;
-    player->y = SPAWN_Y;
-    player->z = SPAWN_Z + 0.5;
-    player->yaw = 0.0f;
-    player->pitch = 0.0f;
-    
     /* Здоровье */
     player->health = 20;
     player->experience = 0.0f;
@@ -41,8 +39,6 @@ Player* player_create(const char* username, const uint8_t* uuid) {
     
     /* Флаги */
     player->spawn_position_sent = false;
-    player->ready = false;
-    player->on_ground = true;
     
     printf("[PLAYER] Создан игрок: %s\n", username);
     
@@ -61,37 +57,83 @@ void player_destroy(Player* player) {
     printf("[PLAYER] Удалён игрок: %s (ID=%d)\n", player->username, player->entity_id);
 }
 
-/* Отправить позицию игрока остальным */
+typedef struct {
+    Player* source;
+    BroadcastPacket* moves[ENTITY_LOD_TIERS];  /* NULL - уровню в этом тике нечего слать */
+} BroadcastVisit;
+
+static void broadcast_visit(Player* target, void* arg) {
+    BroadcastVisit* visit = arg;
+    Player* player = visit->source;
+    
+    if (!server_state.hot.ready[player_slot(target)] || target == player) return;
+    
+    /* Движение нужно только тем, у кого игрок заспавнен, и в такт их уровня */
+    int tier = tracker_tier(target, player);
+    if (tier < 0 || !visit->moves[tier]) return;
+    
+    /* Отправляем обновление позиции */
+    broadcast_send(visit->moves[tier], target);
+}
+
+#define MOVE_THRESHOLD ((int64_t)(POSITION_DELTA_THRESHOLD * 4096))
+
+/* Заметно ли сдвинулся или повернулся игрок с последней рассылки */
+static bool pose_changed(const EntityPose* sent, const EntityPose* now) {
+    return llabs(now->x - sent->x) >= MOVE_THRESHOLD ||
+           llabs(now->y - sent->y) >= MOVE_THRESHOLD ||
+           llabs(now->z - sent->z) >= MOVE_THRESHOLD ||
+           now->yaw != sent->yaw || now->pitch != sent->pitch;
+}
+
+/* Отправить движение игрока остальным. Вызывать под players_lock каждый тик:
+   получатели - отслеживающие его на уровнях, чей такт пришёл, из ячеек
+   сетки в радиусе самого дальнего из них. Мелкие сдвиги копятся до
+   порога - стоящий игрок не шлёт ничего */
 void player_broadcast_position(Player* player) {
-    if (!player || !player->ready) return;
+    if (!player || !player_ready(player)) return;
     
-    pthread_rwlock_rdlock(&server_state.players_lock);
+    EntityPose now;
+    entity_pose_of(&now, player);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        Player* target = &server_state.players[i];
-        
-        if (target->socket <= 0 || !target->ready || target->entity_id == player->entity_id) {
-            continue;
-        }
+    BroadcastPacket packets[ENTITY_LOD_TIERS];
+    EntityPose from[ENTITY_LOD_TIERS];
+    BroadcastVisit visit = { player, { NULL } };
+    int built = 0;
+    int cells = 0;
+    
+    for (int tier = 0; tier < ENTITY_LOD_TIERS; tier++) {
+        if (!tracker_tier_due(player, tier, server_state.current_tick)) continue;
         
-        /* Проверяем расстояние */
-        double dx = player->x - target->x;
-        double dz = player->z - target->z;
-        double distance_sq = dx * dx + dz * dz;
+        EntityPose* sent = tracker_sent_pose(player, tier);
+        if (!pose_changed(sent, &now)) continue;
         
-        /* Рендер дистанция в квадрате */
-        int render_range = RENDER_DISTANCE * 16;
-        int render_range_sq = render_range * render_range;
+        /* Уровни с одинаковым прошлым положением делят один пакет */
+        from[tier] = *sent;
+        for (int prev = 0; prev < tier && !visit.moves[tier]; prev++) {
+            if (visit.moves[prev] && entity_pose_equal(&from[prev], sent)) {
+                visit.moves[tier] = visit.moves[prev];
+            }
+        }
         
-        if (distance_sq > render_range_sq) {
-            continue;
+        /* Пакет собирается один раз на всех получателей уровня */
+        if (!visit.moves[tier]) {
+            visit.moves[tier] = &packets[built++];
+            broadcast_entity_movement(visit.moves[tier], player->entity_id, sent, &now);
         }
         
-        /* Отправляем обновление позиции */
-        packet_send_entity_move_relative(target, player);
+        *sent = now;
+        cells = tracker_tier_cells(tier);
     }
     
-    pthread_rwlock_unlock(&server_state.players_lock);
+    if (built == 0) return;
+    
+    int slot = player_slot(player);
+    grid_query(server_state.hot.x[slot], server_state.hot.z[slot], cells, broadcast_visit, &visit);
+    
+    while (built > 0) {
+        broadcast_free(&packets[--built]);
+    }
 }
 
 /* Установить позицию игрока */
@@ -99,16 +141,31 @@ void player_set_position(Player* player, double x, double y, double z,
                         float yaw, float pitch) {
     if (!player) return;
     
-    player->x = x;
-    player->y = y;
-    player->z = z;
-    player->yaw = yaw;
-    player->pitch = pitch;
+    PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(player);
+    hot->x[slot] = x;
+    hot->y[slot] = y;
+    hot->z[slot] = z;
+    hot->yaw[slot] = yaw;
+    hot->pitch[slot] = pitch;
+    
+    grid_move(player);
+}
+
+/* Обнулить горячие данные слота (новое подключение) */
+void player_hot_reset(Player* player) {
+    PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(player);
+    
+    hot->x[slot] = hot->y[slot] = hot->z[slot] = 0.0;
+    hot->yaw[slot] = hot->pitch[slot] = 0.0f;
+    hot->on_ground[slot] = false;
+    hot->ready[slot] = false;
 }
 
 /* Отправить чанк игроку */
 void player_send_chunk(Player* player, int32_t chunk_x, int32_t chunk_z) {
-    if (!player || !player->ready) return;
+    if (!player || player->protocol_state != PROTOCOL_STATE_PLAY) return;
     
     pthread_rwlock_rdlock(&server_state.chunks_lock);
     
@@ -148,8 +205,9 @@ void player_send_chunk(Player* player, int32_t chunk_x, int32_t chunk_z) {
 void player_load_chunks_around(Player* player) {
     if (!player) return;
     
-    int center_chunk_x = (int)player->x >> 4;
-    int center_chunk_z = (int)player->z >> 4;
+    int slot = player_slot(player);
+    int center_chunk_x = (int)server_state.hot.x[slot] >> 4;
+    int center_chunk_z = (int)server_state.hot.z[slot] >> 4;
     
     int range = RENDER_DISTANCE;
     
@@ -160,35 +218,6 @@ void player_load_chunks_around(Player* player) {
     }
 }
 
-/* Обновить список видимых игроков */
-void player_update_visible_entities(Player* player) {
-    if (!player || !player->ready) return;
-    
-    pthread_rwlock_rdlock(&server_state.players_lock);
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        Player* other = &server_state.players[i];
-        
-        if (other->socket <= 0 || !other->ready || other->entity_id == player->entity_id) {
-            continue;
-        }
-        
-        /* Проверяем расстояние */
-        double dx = other->x - player->x;
-        double dz = other->z - player->z;
-        double distance_sq = dx * dx + dz * dz;
-        
-        int render_range = RENDER_DISTANCE * 16;
-        int render_range_sq = render_range * render_range;
-        
-        if (distance_sq < render_range_sq) {
-            packet_send_entity_spawn(player, other);
-        }
-    }
-    
-    pthread_rwlock_unlock(&server_state.players_lock);
-}
-
 /* Получить здоровье игрока */
 int32_t player_get_health(Player* player) {
     if (!player) return 0;
@@ -215,11 +244,9 @@ void player_set_health(Player* player, int32_t health) {
 Player* player_find_by_name(const char* username) {
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0 && 
-            strcmp(server_state.players[i].username, username) == 0) {
-            
-            Player* found = &server_state.players[i];
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* found = active_player(i);
+        if (found->socket > 0 && strcmp(found->username, username) == 0) {
             pthread_rwlock_unlock(&server_state.players_lock);
             return found;
         }
@@ -233,9 +260,9 @@ Player* player_find_by_name(const char* username) {
 Player* player_find_by_socket(int socket) {
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket == socket) {
-            Player* found = &server_state.players[i];
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* found = active_player(i);
+        if (found->socket == socket) {
             pthread_rwlock_unlock(&server_state.players_lock);
             return found;
         }
@@ -247,7 +274,7 @@ Player* player_find_by_socket(int socket) {
 
 /* Отправить сообщение игроку в чат */
 void player_send_chat_message(Player* player, const char* message) {
-    if (!player || !player->ready) return;
+    if (!player || !player_ready(player)) return;
     
     printf("[CHAT] <%s> %s\n", player->username, message);
     
@@ -258,11 +285,150 @@ void player_send_chat_message(Player* player, const char* message) {
 void server_broadcast_chat(const char* message) {
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
-            player_send_chat_message(&server_state.players[i], message);
+    for (int i = 0; i < server_state.active_players; i++) {
+        if (player_ready(active_player(i))) {
+            player_send_chat_message(active_player(i), message);
+        }
+    }
+    
+    pthread_rwlock_unlock(&server_state.players_lock);
+}
+
+/* === ТАЙМЕРЫ ИГРОКА === */
+
+/* Keep-alive и таймаут каждого слота - в колесе таймеров потока тика.
+   Хранятся отдельно от Player: слот обнуляется сетевым потоком при
+   подключении, а таймер в колесе должен пережить это до срабатывания.
+   Сработавший таймер чужого поколения соединения просто гаснет */
+typedef struct {
+    Timer keep_alive;       /* отправка, затем ожидание ответа */
+    Timer timeout;          /* тишина дольше PLAYER_TIMEOUT */
+    uint32_t generation;    /* поколение соединения, для которого заведены */
+    bool awaiting;          /* Keep Alive отправлен, ответа ещё нет */
+    int64_t keep_alive_id;
+    uint64_t keep_alive_sent;  /* тик отправки */
+    uint64_t last_activity;    /* тик последнего пакета от клиента */
+} PlayerSession;
+
+static PlayerSession sessions[MAX_PLAYERS];
+
+#define KEEP_ALIVE_TICKS TIMER_MS(PLAYER_KEEP_ALIVE_INTERVAL)
+#define KEEP_ALIVE_DEADLINE_TICKS TIMER_MS(PLAYER_KEEP_ALIVE_DEADLINE)
+#define TIMEOUT_TICKS TIMER_MS(PLAYER_TIMEOUT)
+
+static PlayerSession* session_of(Player* player) {
+    return &sessions[player_slot(player)];
+}
+
+/* Игрок слота, если таймер всё ещё относится к его соединению */
+static Player* session_player(PlayerSession* session) {
+    Player* player = &server_state.players[session - sessions];
+    Connection* conn = player->conn;
+    
+    if (!conn || conn->generation != session->generation) return NULL;
+    return player;
+}
+
+static void session_kick(Player* player, const char* reason) {
+    printf("[PLAYER] %s (%s:%d): %s - отключение\n",
+           player->username[0] ? player->username : "?", player->ip, player->port, reason);
+    
+    if (player->protocol_state == PROTOCOL_STATE_PLAY) {
+        packet_send_disconnect(player, reason);
+        network_flush(player->conn);
+    }
+    network_close(player->conn);
+}
+
+static void session_keep_alive_fire(void* arg) {
+    PlayerSession* session = arg;
+    
+    pthread_rwlock_rdlock(&server_state.players_lock);
+    
+    Player* player = session_player(session);
+    if (!player) {
+        pthread_rwlock_unlock(&server_state.players_lock);
+        return;
+    }
+    
+    if (session->awaiting) {
+        session_kick(player, "Нет ответа на Keep Alive");
+    } else if (player->protocol_state != PROTOCOL_STATE_PLAY) {
+        /* Ещё логинится - Keep Alive в этом состоянии не шлём */
+        timer_schedule(&session->keep_alive, KEEP_ALIVE_TICKS);
+    } else {
+        session->keep_alive_id = (int64_t)get_millis();
+        session->keep_alive_sent = timer_now();
+        session->awaiting = true;
+        packet_send_keep_alive(player, session->keep_alive_id);
+        timer_schedule(&session->keep_alive, KEEP_ALIVE_DEADLINE_TICKS);
+    }
+    
+    pthread_rwlock_unlock(&server_state.players_lock);
+}
+
+/* Пакеты от клиента только сдвигают отметку - таймер перезаводится лениво */
+static void session_timeout_fire(void* arg) {
+    PlayerSession* session = arg;
+    
+    pthread_rwlock_rdlock(&server_state.players_lock);
+    
+    Player* player = session_player(session);
+    if (player) {
+        uint64_t idle = timer_now() - session->last_activity;
+        if (idle >= TIMEOUT_TICKS) {
+            session_kick(player, "Превышено время ожидания");
+        } else {
+            timer_schedule(&session->timeout, TIMEOUT_TICKS - idle);
         }
     }
     
     pthread_rwlock_unlock(&server_state.players_lock);
 }
+
+/* Слот занят новым соединением. Поток тика, под players_lock */
+void player_session_start(Player* player) {
+    if (!player || !player->conn) return;
+    
+    PlayerSession* session = session_of(player);
+    int slot = player_slot(player);
+    
+    timer_init(&session->keep_alive, session_keep_alive_fire, session);
+    timer_init(&session->timeout, session_timeout_fire, session);
+    session->generation = player->conn->generation;
+    session->awaiting = false;
+    session->last_activity = timer_now();
+    
+    /* С этого момента игрока видно соседям, а у него самого - пусто.
+       ready - последним: фазы тика берут игрока только с готовыми
+       ячейкой сетки и отслеживанием */
+    grid_insert(player);
+    tracker_reset(player);
+    server_state.hot.ready[slot] = true;
+    
+    /* Первый Keep Alive - со сдвигом по слоту: после рестарта все
+       игроки заходят разом, а отправки должны размазаться по интервалу */
+    timer_schedule(&session->keep_alive, 1 + (uint64_t)slot % KEEP_ALIVE_TICKS);
+    timer_schedule(&session->timeout, TIMEOUT_TICKS);
+}
+
+/* Любой пакет от клиента. Поток тика */
+void player_session_touch(Player* player) {
+    if (!player) return;
+    session_of(player)->last_activity = timer_now();
+}
+
+void player_keep_alive_response(Player* player, int64_t keep_alive_id) {
+    if (!player) return;
+    
+    PlayerSession* session = session_of(player);
+    if (!session->awaiting || keep_alive_id != session->keep_alive_id) return;
+    
+    session->awaiting = false;
+    player->last_keep_alive = get_millis();
+    
+    /* Следующий - через интервал от прошлой отправки, а не от ответа */
+    uint64_t elapsed = timer_now() - session->keep_alive_sent;
+    uint64_t delay = elapsed < KEEP_ALIVE_TICKS ? KEEP_ALIVE_TICKS - elapsed : 1;
+    timer_schedule(&session->keep_alive, delay);
+}
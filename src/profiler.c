@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <string.h>
+#include "profiler.h"
+
+/* Значения - в единицах 1024 нс (~мкс). До 8 единиц - корзина на значение,
+   дальше по 8 корзин на каждую степень двойки, до 2^22 (~4.3 с) */
+#define PROF_SUB_BITS 3
+#define PROF_SUB      (1 << PROF_SUB_BITS)
+#define PROF_MAX_EXP  22
+#define PROF_BUCKETS  ((PROF_MAX_EXP - PROF_SUB_BITS + 2) * PROF_SUB)
+#define PROF_UNIT_SHIFT 10
+
+typedef struct {
+    uint32_t counts[PROF_PHASE_COUNT][PROF_BUCKETS];
+    uint64_t max[PROF_PHASE_COUNT];  /* нс, точно */
+} ProfSlice;
+
+static ProfSlice slices[PROFILE_WINDOW_SLICES];
+static unsigned current = 0;
+static uint64_t slice_start = 0;
+
+static const char* phase_names[PROF_PHASE_COUNT] = {
+    [PROF_ACTIONS]  = "actions",
+    [PROF_TIMERS]   = "timers",
+    [PROF_MOBS]     = "mobs",
+    [PROF_REDSTONE] = "redstone",
+    [PROF_FLUIDS]   = "fluids",
+    [PROF_ENTITIES] = "entities",
+    [PROF_SAVE]     = "save",
+    [PROF_FLUSH]    = "flush",
+    [PROF_TICK]     = "tick",
+};
+
+static unsigned bucket_index(uint64_t ns) {
+    uint64_t v = ns >> PROF_UNIT_SHIFT;
+    if (v < PROF_SUB) return (unsigned)v;
+
+    unsigned exp = 63 - (unsigned)__builtin_clzll(v);
+    if (exp > PROF_MAX_EXP) return PROF_BUCKETS - 1;
+
+    unsigned sub = (unsigned)(v >> (exp - PROF_SUB_BITS)) & (PROF_SUB - 1);
+    return (exp - PROF_SUB_BITS + 1) * PROF_SUB + sub;
+}
+
+/* Верхняя граница корзины, нс: перцентиль не занижается */
+static uint64_t bucket_upper(unsigned index) {
+    if (index < PROF_SUB) return (uint64_t)(index + 1) << PROF_UNIT_SHIFT;
+
+    unsigned exp = index / PROF_SUB + PROF_SUB_BITS - 1;
+    uint64_t sub = index % PROF_SUB;
+    uint64_t lower = (PROF_SUB + sub) << (exp - PROF_SUB_BITS);
+    return (lower + (1ULL << (exp - PROF_SUB_BITS))) << PROF_UNIT_SHIFT;
+}
+
+void prof_record(ProfPhase phase, uint64_t ns) {
+    ProfSlice* slice = &slices[__atomic_load_n(&current, __ATOMIC_RELAXED)];
+    __atomic_fetch_add(&slice->counts[phase][bucket_index(ns)], 1, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&slice->max[phase], __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&slice->max[phase], &max, ns, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void profiler_tick_end() {
+#if PROFILE_TICKS
+    uint64_t now = prof_now();
+    if (slice_start == 0) slice_start = now;
+    if (now - slice_start < (uint64_t)PROFILE_SLICE * 1000000ULL) return;
+
+    /* Самый старый срез очищается и становится текущим */
+    unsigned next = (current + 1) % PROFILE_WINDOW_SLICES;
+    memset(&slices[next], 0, sizeof(slices[next]));
+    __atomic_store_n(&current, next, __ATOMIC_RELAXED);
+    slice_start = now;
+#endif
+}
+
+static double percentile_ms(const uint64_t* counts, uint64_t total, double q) {
+    uint64_t rank = (uint64_t)(q * (double)total);
+    if (rank >= total) rank = total - 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < PROF_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen > rank) return (double)bucket_upper(i) / 1e6;
+    }
+    return (double)bucket_upper(PROF_BUCKETS - 1) / 1e6;
+}
+
+void profiler_report() {
+#if PROFILE_TICKS
+    printf("[PROF] фаза       замеров      p50      p95      p99      max  (мс, окно %d с)\n",
+           PROFILE_SLICE * PROFILE_WINDOW_SLICES / 1000);
+
+    for (int phase = 0; phase < PROF_PHASE_COUNT; phase++) {
+        uint64_t counts[PROF_BUCKETS] = {0};
+        uint64_t total = 0;
+        uint64_t max = 0;
+
+        for (int s = 0; s < PROFILE_WINDOW_SLICES; s++) {
+            for (unsigned i = 0; i < PROF_BUCKETS; i++) {
+                uint32_t c = __atomic_load_n(&slices[s].counts[phase][i], __ATOMIC_RELAXED);
+                counts[i] += c;
+                total += c;
+            }
+            uint64_t m = __atomic_load_n(&slices[s].max[phase], __ATOMIC_RELAXED);
+            if (m > max) max = m;
+        }
+
+        if (total == 0) continue;
+
+        /* Граница корзины может оказаться выше точного максимума */
+        double max_ms = (double)max / 1e6;
+        double p50 = percentile_ms(counts, total, 0.50);
+        double p95 = percentile_ms(counts, total, 0.95);
+        double p99 = percentile_ms(counts, total, 0.99);
+
+        printf("[PROF] %-9s %8llu %8.2f %8.2f %8.2f %8.2f\n", phase_names[phase],
+               (unsigned long long)total, p50 < max_ms ? p50 : max_ms,
+               p95 < max_ms ? p95 : max_ms, p99 < max_ms ? p99 : max_ms, max_ms);
+    }
+#endif
+}
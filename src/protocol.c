@@ -1,99 +1,148 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include "protocol.h"
 #include "server.h"
+#include "network.h"
+#include "arena.h"
+#include "compress.h"
+#include "chunk_cache.h"
+#include "varint.h"
+#include "utils.h"
 
 /* === БУФЕР ПАКЕТОВ === */
 
+/* Память буферов берётся из арены потока, крупные блоки - из кучи */
+static void* buffer_mem_alloc(size_t size) {
+    void* ptr = arena_alloc(size);
+    return ptr ? ptr : malloc(size);
+}
+
+static void buffer_mem_free(void* ptr, size_t size) {
+    if (arena_owns(ptr)) {
+        arena_free(ptr, size);
+    } else {
+        free(ptr);
+    }
+}
+
 PacketBuffer* buffer_create(size_t initial_size) {
-    PacketBuffer* buf = malloc(sizeof(PacketBuffer));
+    PacketBuffer* buf = buffer_mem_alloc(sizeof(PacketBuffer));
     if (!buf) return NULL;
     
-    buf->data = malloc(initial_size);
+    if (initial_size == 0) initial_size = 64;
+    buf->data = buffer_mem_alloc(initial_size);
     if (!buf->data) {
-        free(buf);
+        buffer_mem_free(buf, sizeof(PacketBuffer));
         return NULL;
     }
     
     buf->size = initial_size;
     buf->position = 0;
+    buf->head = 0;
     
     return buf;
 }
 
+/* Освобождать в том же потоке, где буфер создан (арена потоколокальная) */
 void buffer_free(PacketBuffer* buf) {
     if (!buf) return;
-    if (buf->data) free(buf->data);
-    free(buf);
+    /* Обратный порядок: сначала данные, потом структура - обе вернутся в арену */
+    if (buf->data) buffer_mem_free(buf->data, buf->size);
+    buffer_mem_free(buf, sizeof(PacketBuffer));
 }
 
-/* VarInt кодирование */
-static void buffer_write_varint(PacketBuffer* buf, int32_t value) {
-    while ((value & 0xFFFFFF80) != 0) {
-        if (buf->position >= buf->size - 1) {
-            buf->size *= 2;
-            buf->data = realloc(buf->data, buf->size);
-        }
-        buf->data[buf->position++] = (uint8_t)((value & 0x7F) | 0x80);
-        value >>= 7;
+/* Гарантировать место под extra байт после position */
+static bool buffer_reserve(PacketBuffer* buf, size_t extra) {
+    size_t needed = buf->position + extra;
+    if (LIKELY(needed <= buf->size)) return true;
+    
+    size_t new_size = buf->size * 2;
+    while (new_size < needed) new_size *= 2;
+    
+    /* Последний блок арены растёт на месте, без копирования */
+    if (arena_extend(buf->data, buf->size, new_size)) {
+        buf->size = new_size;
+        return true;
     }
-    if (buf->position >= buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
-    buf->data[buf->position++] = (uint8_t)(value & 0x7F);
+    
+    uint8_t* data = buffer_mem_alloc(new_size);
+    if (!data) return false;
+    
+    memcpy(data, buf->data, buf->position);
+    buffer_mem_free(buf->data, buf->size);
+    buf->data = data;
+    buf->size = new_size;
+    return true;
 }
 
-static int32_t buffer_read_varint(PacketBuffer* buf) {
-    int32_t result = 0;
-    int shift = 0;
-    
-    while (buf->position < buf->size) {
-        uint8_t byte = buf->data[buf->position++];
-        result |= (int32_t)(byte & 0x7F) << shift;
-        
-        if ((byte & 0x80) == 0) {
-            return result;
-        }
-        shift += 7;
-    }
+PacketBuffer* packet_create(size_t payload_size) {
+    PacketBuffer* buf = buffer_create(payload_size + PACKET_HEADROOM);
+    if (!buf) return NULL;
     
-    return 0;
+    buf->position = PACKET_HEADROOM;
+    buf->head = PACKET_HEADROOM;
+    return buf;
+}
+
+/* Дописать ID пакета перед данными, вернуть длину тела (ID + данные) */
+static size_t packet_prepend_id(PacketBuffer* buf, int32_t packet_id) {
+    int id_len = varint_size(packet_id);
+    buf->head -= id_len;
+    varint_encode(&buf->data[buf->head], packet_id);
+    return buf->position - buf->head;
+}
+
+size_t packet_finish(PacketBuffer* buf, int32_t packet_id) {
+    int32_t frame_len = (int32_t)packet_prepend_id(buf, packet_id);
+    int len_len = varint_size(frame_len);
+    
+    /* Заголовок пишется вплотную к данным, назад от начала payload */
+    buf->head -= len_len;
+    varint_encode(&buf->data[buf->head], frame_len);
+    return buf->position - buf->head;
+}
+
+/* VarInt кодирование */
+void buffer_write_varint(PacketBuffer* buf, int32_t value) {
+    if (!buffer_reserve(buf, VARINT_MAX_BYTES)) return;
+    buf->position += varint_encode(&buf->data[buf->position], (uint32_t)value);
+}
+
+void buffer_write_varlong(PacketBuffer* buf, int64_t value) {
+    if (!buffer_reserve(buf, VARLONG_MAX_BYTES)) return;
+    buf->position += varlong_encode(&buf->data[buf->position], (uint64_t)value);
+}
+
+/* Массив VarInt (палитры, списки ID): одна проверка места на весь массив */
+void buffer_write_varint_array(PacketBuffer* buf, const int32_t* values, size_t count) {
+    if (!buffer_reserve(buf, count * VARINT_MAX_BYTES)) return;
+    buf->position += varint_encode_batch(&buf->data[buf->position],
+                                         (const uint32_t*)values, count);
 }
 
 void buffer_write_byte(PacketBuffer* buf, uint8_t value) {
-    if (buf->position >= buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 1)) return;
     buf->data[buf->position++] = value;
 }
 
 void buffer_write_short(PacketBuffer* buf, int16_t value) {
-    if (buf->position + 2 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 2)) return;
     *(int16_t*)&buf->data[buf->position] = htons(value);
     buf->position += 2;
 }
 
 void buffer_write_int(PacketBuffer* buf, int32_t value) {
-    if (buf->position + 4 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 4)) return;
     *(int32_t*)&buf->data[buf->position] = htonl(value);
     buf->position += 4;
 }
 
 void buffer_write_long(PacketBuffer* buf, int64_t value) {
-    if (buf->position + 8 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 8)) return;
     uint32_t high = htonl((uint32_t)(value >> 32));
     uint32_t low = htonl((uint32_t)(value & 0xFFFFFFFF));
     *(uint32_t*)&buf->data[buf->position] = high;
@@ -102,10 +151,7 @@ void buffer_write_long(PacketBuffer* buf, int64_t value) {
 }
 
 void buffer_write_float(PacketBuffer* buf, float value) {
-    if (buf->position + 4 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 4)) return;
     uint32_t bits;
     memcpy(&bits, &value, 4);
     *(uint32_t*)&buf->data[buf->position] = htonl(bits);
@@ -113,10 +159,7 @@ void buffer_write_float(PacketBuffer* buf, float value) {
 }
 
 void buffer_write_double(PacketBuffer* buf, double value) {
-    if (buf->position + 8 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 8)) return;
     uint64_t bits;
     memcpy(&bits, &value, 8);
     uint32_t high = htonl((uint32_t)(bits >> 32));
@@ -132,20 +175,14 @@ void buffer_write_string(PacketBuffer* buf, const char* str) {
     
     buffer_write_varint(buf, (int32_t)len);
     
-    if (buf->position + len > buf->size) {
-        buf->size = buf->position + len + 256;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, len)) return;
     
     memcpy(&buf->data[buf->position], str, len);
     buf->position += len;
 }
 
 void buffer_write_uuid(PacketBuffer* buf, const uint8_t* uuid) {
-    if (buf->position + 16 > buf->size) {
-        buf->size *= 2;
-        buf->data = realloc(buf->data, buf->size);
-    }
+    if (!buffer_reserve(buf, 16)) return;
     memcpy(&buf->data[buf->position], uuid, 16);
     buf->position += 16;
 }
@@ -157,110 +194,230 @@ void buffer_write_position(PacketBuffer* buf, int32_t x, int32_t y, int32_t z) {
     buffer_write_long(buf, value);
 }
 
-/* Чтение */
-uint8_t buffer_read_byte(PacketBuffer* buf) {
-    if (buf->position >= buf->size) return 0;
-    return buf->data[buf->position++];
+/* === ЧТЕНИЕ КАДРА === */
+
+void reader_init(PacketReader* r, const uint8_t* data, size_t len) {
+    r->data = data;
+    r->len = len;
+    r->pos = 0;
+    r->error = false;
 }
 
-int16_t buffer_read_short(PacketBuffer* buf) {
-    if (buf->position + 2 > buf->size) return 0;
-    int16_t value = ntohs(*(int16_t*)&buf->data[buf->position]);
-    buf->position += 2;
-    return value;
+/* Взять n байт кадра. После первой ошибки читать больше нечего */
+static inline const uint8_t* reader_take(PacketReader* r, size_t n) {
+    if (r->error || n > r->len - r->pos) {
+        r->error = true;
+        r->pos = r->len;
+        return NULL;
+    }
+    
+    const uint8_t* p = r->data + r->pos;
+    r->pos += n;
+    return p;
 }
 
-int32_t buffer_read_int(PacketBuffer* buf) {
-    if (buf->position + 4 > buf->size) return 0;
-    int32_t value = ntohl(*(int32_t*)&buf->data[buf->position]);
-    buf->position += 4;
-    return value;
+static inline uint32_t load_be32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return ntohl(value);
 }
 
-int64_t buffer_read_long(PacketBuffer* buf) {
-    if (buf->position + 8 > buf->size) return 0;
-    uint32_t high = ntohl(*(uint32_t*)&buf->data[buf->position]);
-    uint32_t low = ntohl(*(uint32_t*)&buf->data[buf->position + 4]);
-    buf->position += 8;
-    return ((int64_t)high << 32) | low;
+static inline uint64_t load_be64(const uint8_t* p) {
+    return ((uint64_t)load_be32(p) << 32) | load_be32(p + 4);
 }
 
-float buffer_read_float(PacketBuffer* buf) {
-    if (buf->position + 4 > buf->size) return 0.0f;
-    uint32_t bits = ntohl(*(uint32_t*)&buf->data[buf->position]);
-    buf->position += 4;
+int32_t reader_varint(PacketReader* r) {
+    uint32_t value = 0;
+    int len = r->error ? -1 : varint_decode(r->data + r->pos, r->len - r->pos, &value);
+    if (len <= 0) {
+        r->error = true;
+        r->pos = r->len;
+        return 0;
+    }
+    
+    r->pos += (size_t)len;
+    return (int32_t)value;
+}
+
+uint8_t reader_byte(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 1);
+    return p ? p[0] : 0;
+}
+
+int16_t reader_short(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 2);
+    return p ? (int16_t)((p[0] << 8) | p[1]) : 0;
+}
+
+int32_t reader_int(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 4);
+    return p ? (int32_t)load_be32(p) : 0;
+}
+
+int64_t reader_long(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 8);
+    return p ? (int64_t)load_be64(p) : 0;
+}
+
+float reader_float(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 4);
+    if (!p) return 0.0f;
+    
+    uint32_t bits = load_be32(p);
     float value;
     memcpy(&value, &bits, 4);
     return value;
 }
 
-double buffer_read_double(PacketBuffer* buf) {
-    if (buf->position + 8 > buf->size) return 0.0;
-    uint32_t high = ntohl(*(uint32_t*)&buf->data[buf->position]);
-    uint32_t low = ntohl(*(uint32_t*)&buf->data[buf->position + 4]);
-    buf->position += 8;
-    uint64_t bits = ((uint64_t)high << 32) | low;
+double reader_double(PacketReader* r) {
+    const uint8_t* p = reader_take(r, 8);
+    if (!p) return 0.0;
+    
+    uint64_t bits = load_be64(p);
     double value;
     memcpy(&value, &bits, 8);
     return value;
 }
 
-char* buffer_read_string(PacketBuffer* buf, size_t max_len) {
-    int32_t len = buffer_read_varint(buf);
-    if (len < 0 || len > (int32_t)max_len) {
-        return NULL;
+/* Длина больше max_len - тоже ошибка кадра: клиент нарушил протокол */
+StringView reader_string(PacketReader* r, size_t max_len) {
+    StringView view = { NULL, 0 };
+    int32_t len = reader_varint(r);
+    if (len < 0 || (size_t)len > max_len) {
+        r->error = true;
+        r->pos = r->len;
+        return view;
     }
     
-    char* str = malloc(len + 1);
-    if (!str) return NULL;
-    
-    memcpy(str, &buf->data[buf->position], len);
-    buf->position += len;
-    str[len] = '\0';
-    
-    return str;
+    const uint8_t* p = reader_take(r, (size_t)len);
+    if (p) {
+        view.data = (const char*)p;
+        view.len = (size_t)len;
+    }
+    return view;
 }
 
-void buffer_read_uuid(PacketBuffer* buf, uint8_t* uuid) {
-    if (buf->position + 16 > buf->size) return;
-    memcpy(uuid, &buf->data[buf->position], 16);
-    buf->position += 16;
+const uint8_t* reader_bytes(PacketReader* r, size_t len) {
+    return reader_take(r, len);
+}
+
+void reader_uuid(PacketReader* r, uint8_t* uuid) {
+    const uint8_t* p = reader_take(r, 16);
+    if (p) memcpy(uuid, p, 16);
+    else memset(uuid, 0, 16);
 }
 
 /* === ОТПРАВКА ПАКЕТОВ === */
 
-static void send_packet(Player* player, int32_t packet_id, PacketBuffer* payload) {
-    if (!player || player->socket <= 0 || !payload) return;
+/* Тело ниже порога сжатия: Data Length = 0, тело как есть */
+static size_t packet_wrap_uncompressed(PacketBuffer* buf, size_t body_len) {
+    int32_t frame_len = (int32_t)body_len + 1;
+    buf->data[--buf->head] = 0;
+    buf->head -= varint_size(frame_len);
+    varint_encode(&buf->data[buf->head], frame_len);
+    return buf->position - buf->head;
+}
+
+static Frame* frame_copy(const uint8_t* data, size_t len) {
+    Frame* frame = frame_alloc(len);
+    if (!frame) return NULL;
+    
+    memcpy(frame->buf, data, len);
+    frame->len = len;
+    frame_set_ready(frame);
+    return frame;
+}
+
+Frame* packet_build_frame(PacketBuffer* payload, int32_t packet_id, bool compression) {
+    if (!payload) return NULL;
     
-    PacketBuffer* packet = buffer_create(payload->position + 16);
+    if (!compression) {
+        size_t len = packet_finish(payload, packet_id);
+        return frame_copy(payload->data + payload->head, len);
+    }
+    
+    size_t body_len = packet_prepend_id(payload, packet_id);
     
-    /* Пишем ID пакета */
-    buffer_write_varint(packet, packet_id);
+    if ((int)body_len < COMPRESSION_THRESHOLD) {
+        size_t len = packet_wrap_uncompressed(payload, body_len);
+        return frame_copy(payload->data + payload->head, len);
+    }
     
-    /* Копируем payload */
-    memcpy(&packet->data[packet->position], payload->data, payload->position);
-    packet->position += payload->position;
+    if (body_len < COMPRESSION_ASYNC_MIN) {
+        Frame* frame = frame_alloc(compress_frame_bound(body_len));
+        if (!frame) return NULL;
+        
+        frame->data = compress_frame(payload->data + payload->head, body_len,
+                                     frame->buf, frame->cap, &frame->len);
+        if (!frame->data) {
+            frame_release(frame);
+            return NULL;
+        }
+        frame_set_ready(frame);
+        return frame;
+    }
     
-    /* Пишем длину пакета в начало */
-    PacketBuffer* final_packet = buffer_create(packet->position + 8);
-    buffer_write_varint(final_packet, (int32_t)packet->position);
-    memcpy(&final_packet->data[final_packet->position], packet->data, packet->position);
-    final_packet->position += packet->position;
+    return compress_frame_async(payload->data + payload->head, body_len);
+}
+
+static void send_packet(Player* player, int32_t packet_id, PacketBuffer* payload) {
+    if (!player || player->socket <= 0 || !payload) return;
     
-    /* Отправляем */
-    ssize_t sent = send(player->socket, final_packet->data, final_packet->position, 0);
-    if (sent < 0) {
-        printf("[WARNING] Не удалось отправить пакет игроку %s\n", player->username);
+    if (!player->compression) {
+        /* Заголовок дописывается в резерв перед данными - без аллокаций и копий */
+        size_t len = packet_finish(payload, packet_id);
+        
+        /* В очередь соединения - уйдёт одним writev в конце тика */
+        network_queue(player->conn, payload->data + payload->head, len);
+        return;
     }
     
-    buffer_free(packet);
-    buffer_free(final_packet);
+    size_t body_len = packet_prepend_id(payload, packet_id);
+    
+    if ((int)body_len < COMPRESSION_THRESHOLD) {
+        size_t len = packet_wrap_uncompressed(payload, body_len);
+        network_queue(player->conn, payload->data + payload->head, len);
+    } else if (body_len < COMPRESSION_ASYNC_MIN) {
+        /* Средние пакеты сжимаем сразу - очередь пула дороже самого deflate */
+        size_t cap = compress_frame_bound(body_len);
+        uint8_t* out = buffer_mem_alloc(cap);
+        size_t len = 0;
+        uint8_t* frame = out ? compress_frame(payload->data + payload->head, body_len,
+                                              out, cap, &len) : NULL;
+        if (frame) {
+            network_queue(player->conn, frame, len);
+        } else {
+            network_close(player->conn);
+        }
+        if (out) buffer_mem_free(out, cap);
+    } else {
+        /* Крупные (данные чанков) - в пул сжатия; очередь дождётся кадра */
+        Frame* frame = compress_frame_async(payload->data + payload->head, body_len);
+        if (frame) {
+            network_queue_frame(player->conn, frame);
+            frame_release(frame);
+        } else {
+            network_close(player->conn);
+        }
+    }
+}
+
+void packet_send_set_compression(Player* player, int32_t threshold) {
+    if (!player) return;
+    
+    PacketBuffer* payload = packet_create(8);
+    buffer_write_varint(payload, threshold);
+    send_packet(player, 0x03, payload);  /* Set Compression (login) */
+    buffer_free(payload);
+    
+    /* Всё, что отправлено после, клиент ждёт в сжатом формате */
+    player->compression = true;
 }
 
 void packet_send_login_success(Player* player) {
     if (!player) return;
     
-    PacketBuffer* payload = buffer_create(256);
+    PacketBuffer* payload = packet_create(256);
     
     /* UUID */
     buffer_write_uuid(payload, player->uuid);
@@ -280,7 +437,7 @@ void packet_send_login_success(Player* player) {
 void packet_send_spawn_position(Player* player) {
     if (!player) return;
     
-    PacketBuffer* payload = buffer_create(32);
+    PacketBuffer* payload = packet_create(32);
     
     /* Позиция спауна */
     buffer_write_position(payload, SPAWN_X, SPAWN_Y, SPAWN_Z);
@@ -295,16 +452,18 @@ void packet_send_spawn_position(Player* player) {
 void packet_send_player_position_and_look(Player* player) {
     if (!player) return;
     
-    PacketBuffer* payload = buffer_create(64);
+    PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(player);
+    PacketBuffer* payload = packet_create(64);
     
     /* X, Y, Z */
-    buffer_write_double(payload, player->x);
-    buffer_write_double(payload, player->y);
-    buffer_write_double(payload, player->z);
+    buffer_write_double(payload, hot->x[slot]);
+    buffer_write_double(payload, hot->y[slot]);
+    buffer_write_double(payload, hot->z[slot]);
     
     /* Yaw, Pitch */
-    buffer_write_float(payload, player->yaw);
-    buffer_write_float(payload, player->pitch);
+    buffer_write_float(payload, hot->yaw[slot]);
+    buffer_write_float(payload, hot->pitch[slot]);
     
     /* Flags (0 = absolute positioning) */
     buffer_write_byte(payload, 0x00);
@@ -319,12 +478,8 @@ void packet_send_player_position_and_look(Player* player) {
     buffer_free(payload);
 }
 
-void packet_send_chunk_data(Player* player, Chunk* chunk) {
-    if (!player || !chunk) return;
-    
-    /* Упрощённо: отправляем только основную информацию о чанке */
-    PacketBuffer* payload = buffer_create(8192);
-    
+/* Данные пакета Chunk Data */
+static void write_chunk_data(PacketBuffer* payload, Chunk* chunk) {
     /* Координаты чанка */
     buffer_write_int(payload, chunk->x);
     buffer_write_int(payload, chunk->z);
@@ -340,27 +495,80 @@ void packet_send_chunk_data(Player* player, Chunk* chunk) {
     payload->position += sizeof(chunk->blocks);
     
     buffer_write_varint(payload, 0);  /* block entities count */
-    
-    send_packet(player, 0x21, payload);  /* Chunk Data */
-    buffer_free(payload);
 }
 
-void packet_send_block_change(Player* player, int32_t x, int32_t y, int32_t z, uint8_t block_id) {
-    if (!player) return;
-    
-    PacketBuffer* payload = buffer_create(32);
+void packet_send_chunk_data(Player* player, Chunk* chunk) {
+    if (!player || !chunk || player->socket <= 0) return;
+    
+    /* Версию читаем до сериализации: гонка с block_set даст лишь промах кэша */
+    uint32_t version = chunk_version(chunk);
+    
+    /* Один раз собранный (и сжатый) кадр чанка уходит всем по ссылке */
+    Frame* frame = chunk_cache_lookup(chunk->x, chunk->z, version, player->compression);
+    if (!frame) {
+        /* Копия блоков - под chunks_lock (жидкости и block_set пишут под
+           записью), сжатие - уже без блокировки */
+        PacketBuffer* payload = packet_create(sizeof(chunk->blocks) + 64);
+        pthread_rwlock_rdlock(&server_state.chunks_lock);
+        write_chunk_data(payload, chunk);
+        pthread_rwlock_unlock(&server_state.chunks_lock);
+        frame = packet_build_frame(payload, 0x21, player->compression);  /* Chunk Data */
+        buffer_free(payload);
+        
+        if (!frame) {
+            network_close(player->conn);
+            return;
+        }
+        chunk_cache_store(chunk->x, chunk->z, version, player->compression, frame);
+    }
     
+    network_queue_frame(player->conn, frame);
+    frame_release(frame);
+}
+
+static void write_block_change(PacketBuffer* payload, int32_t x, int32_t y, int32_t z,
+                               uint8_t block_id) {
     buffer_write_position(payload, x, y, z);
     buffer_write_varint(payload, block_id);
+}
+
+void packet_send_block_change(Player* player, int32_t x, int32_t y, int32_t z, uint8_t block_id) {
+    if (!player) return;
     
+    PacketBuffer* payload = packet_create(32);
+    write_block_change(payload, x, y, z, block_id);
     send_packet(player, 0x09, payload);  /* Block Change */
     buffer_free(payload);
 }
 
-void packet_send_entity_spawn(Player* player, Player* entity) {
-    if (!player || !entity) return;
+/* === ПОЛОЖЕНИЕ СУЩНОСТЕЙ === */
+
+/* Угол в 1/256 оборота (отрицательные - по модулю) */
+static inline uint8_t angle_byte(float degrees) {
+    return (uint8_t)(int32_t)floorf(degrees * 256.0f / 360.0f);
+}
+
+void entity_pose_of(EntityPose* pose, const Player* entity) {
+    const PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(entity);
+    
+    pose->x = (int64_t)llround(hot->x[slot] * 4096.0);
+    pose->y = (int64_t)llround(hot->y[slot] * 4096.0);
+    pose->z = (int64_t)llround(hot->z[slot] * 4096.0);
+    pose->yaw = angle_byte(hot->yaw[slot]);
+    pose->pitch = angle_byte(hot->pitch[slot]);
+    pose->on_ground = hot->on_ground[slot];
+}
+
+bool entity_pose_equal(const EntityPose* a, const EntityPose* b) {
+    return a->x == b->x && a->y == b->y && a->z == b->z &&
+           a->yaw == b->yaw && a->pitch == b->pitch && a->on_ground == b->on_ground;
+}
+
+void packet_send_entity_spawn(Player* player, Player* entity, const EntityPose* pose) {
+    if (!player || !entity || !pose) return;
     
-    PacketBuffer* payload = buffer_create(64);
+    PacketBuffer* payload = packet_create(64);
     
     /* Entity ID */
     buffer_write_varint(payload, entity->entity_id);
@@ -371,17 +579,17 @@ void packet_send_entity_spawn(Player* player, Player* entity) {
     /* Type (PLAYER = 0x0F) */
     buffer_write_varint(payload, 0x0F);
     
-    /* X, Y, Z (в 1/4096 блока) */
-    buffer_write_double(payload, entity->x);
-    buffer_write_double(payload, entity->y);
-    buffer_write_double(payload, entity->z);
+    /* X, Y, Z - ровно то положение, от которого считаются движения */
+    buffer_write_double(payload, pose->x / 4096.0);
+    buffer_write_double(payload, pose->y / 4096.0);
+    buffer_write_double(payload, pose->z / 4096.0);
     
     /* Pitch, Yaw */
-    buffer_write_byte(payload, (uint8_t)(entity->pitch * 256 / 360));
-    buffer_write_byte(payload, (uint8_t)(entity->yaw * 256 / 360));
+    buffer_write_byte(payload, pose->pitch);
+    buffer_write_byte(payload, pose->yaw);
     
     /* Head Yaw */
-    buffer_write_byte(payload, (uint8_t)(entity->yaw * 256 / 360));
+    buffer_write_byte(payload, pose->yaw);
     
     /* Velocity */
     buffer_write_short(payload, 0);
@@ -392,45 +600,87 @@ void packet_send_entity_spawn(Player* player, Player* entity) {
     buffer_free(payload);
 }
 
-void packet_send_entity_destroy(Player* player, int32_t entity_id) {
-    if (!player) return;
-    
-    PacketBuffer* payload = buffer_create(16);
-    
+static void write_entity_destroy(PacketBuffer* payload, const int32_t* entity_ids, int count) {
     /* Count */
-    buffer_write_varint(payload, 1);
+    buffer_write_varint(payload, count);
     
-    /* Entity ID */
-    buffer_write_varint(payload, entity_id);
+    /* Entity IDs */
+    buffer_write_varint_array(payload, entity_ids, (size_t)count);
+}
+
+void packet_send_entity_destroy(Player* player, int32_t entity_id) {
+    packet_send_entities_destroy(player, &entity_id, 1);
+}
+
+void packet_send_entities_destroy(Player* player, const int32_t* entity_ids, int count) {
+    if (!player || count <= 0) return;
     
+    PacketBuffer* payload = packet_create(8 + (size_t)count * VARINT_MAX_BYTES);
+    write_entity_destroy(payload, entity_ids, count);
     send_packet(player, 0x3A, payload);  /* Destroy Entities */
     buffer_free(payload);
 }
 
-void packet_send_entity_move_relative(Player* player, Player* entity) {
-    if (!player || !entity) return;
+static inline bool delta_fits(int64_t delta) {
+    return delta >= INT16_MIN && delta <= INT16_MAX;
+}
+
+/* Сдвиг от from к to: ID пакета или 0, если его не выразить в int16 */
+static int32_t write_entity_move_relative(PacketBuffer* payload, int32_t entity_id,
+                                          const EntityPose* from, const EntityPose* to) {
+    int64_t dx = to->x - from->x;
+    int64_t dy = to->y - from->y;
+    int64_t dz = to->z - from->z;
     
-    PacketBuffer* payload = buffer_create(32);
+    if (!delta_fits(dx) || !delta_fits(dy) || !delta_fits(dz)) return 0;
+    
+    bool moved = dx != 0 || dy != 0 || dz != 0;
+    bool rotated = to->yaw != from->yaw || to->pitch != from->pitch;
     
     /* Entity ID */
-    buffer_write_varint(payload, entity->entity_id);
+    buffer_write_varint(payload, entity_id);
     
-    /* Delta X, Y, Z (в 1/4096 блока, заполнитель) */
-    buffer_write_short(payload, (int16_t)(entity->x * 4096));
-    buffer_write_short(payload, (int16_t)(entity->y * 4096));
-    buffer_write_short(payload, (int16_t)(entity->z * 4096));
+    /* Delta X, Y, Z (в 1/4096 блока) */
+    if (moved) {
+        buffer_write_short(payload, (int16_t)dx);
+        buffer_write_short(payload, (int16_t)dy);
+        buffer_write_short(payload, (int16_t)dz);
+    }
+    
+    /* Yaw, Pitch */
+    if (rotated) {
+        buffer_write_byte(payload, to->yaw);
+        buffer_write_byte(payload, to->pitch);
+    }
     
     /* On Ground */
-    buffer_write_byte(payload, entity->on_ground ? 1 : 0);
+    buffer_write_byte(payload, to->on_ground ? 1 : 0);
     
-    send_packet(player, 0x2A, payload);  /* Entity Position */
-    buffer_free(payload);
+    if (!rotated) return 0x29;  /* Entity Position */
+    return moved ? 0x2A : 0x2B;  /* Entity Position and Rotation / Entity Rotation */
+}
+
+static void write_entity_teleport(PacketBuffer* payload, int32_t entity_id, const EntityPose* to) {
+    /* Entity ID */
+    buffer_write_varint(payload, entity_id);
+    
+    /* X, Y, Z */
+    buffer_write_double(payload, to->x / 4096.0);
+    buffer_write_double(payload, to->y / 4096.0);
+    buffer_write_double(payload, to->z / 4096.0);
+    
+    /* Yaw, Pitch */
+    buffer_write_byte(payload, to->yaw);
+    buffer_write_byte(payload, to->pitch);
+    
+    /* On Ground */
+    buffer_write_byte(payload, to->on_ground ? 1 : 0);
 }
 
 void packet_send_keep_alive(Player* player, int64_t keep_alive_id) {
     if (!player) return;
     
-    PacketBuffer* payload = buffer_create(16);
+    PacketBuffer* payload = packet_create(16);
     buffer_write_long(payload, keep_alive_id);
     
     send_packet(player, 0x21, payload);  /* Keep Alive */
@@ -440,7 +690,7 @@ void packet_send_keep_alive(Player* player, int64_t keep_alive_id) {
 void packet_send_disconnect(Player* player, const char* reason) {
     if (!player) return;
     
-    PacketBuffer* payload = buffer_create(256);
+    PacketBuffer* payload = packet_create(256);
     
     /* JSON chat */
     char json[512];
@@ -453,32 +703,24 @@ void packet_send_disconnect(Player* player, const char* reason) {
 
 /* === ОБРАБОТКА ПАКЕТОВ === */
 
-void protocol_handshake(Player* player, PacketBuffer* buf) {
-    if (!player || !buf) return;
+void protocol_login_start(Player* player, PacketReader* r) {
+    if (!player || !r) return;
     
-    int32_t protocol_version = buffer_read_varint(buf);
-    char* server_address = buffer_read_string(buf, 256);
-    int16_t server_port = buffer_read_short(buf);
-    int32_t next_state = buffer_read_varint(buf);
+    StringView username = reader_string(r, 16);
+    if (r->error) return;
     
-    printf("[PROTOCOL] Handshake: version=%d, state=%d\n", protocol_version, next_state);
+    size_t len = username.len < sizeof(player->username) - 1 ? username.len
+                                                              : sizeof(player->username) - 1;
+    memcpy(player->username, username.data, len);
+    player->username[len] = '\0';
+    player->protocol_state = PROTOCOL_STATE_PLAY;
     
-    player->protocol_state = next_state;
+    printf("[PROTOCOL] Login Start: %s\n", player->username);
     
-    if (server_address) free(server_address);
-}
-
-void protocol_login_start(Player* player, PacketBuffer* buf) {
-    if (!player || !buf) return;
-    
-    char* username = buffer_read_string(buf, 16);
-    if (!username) return;
-    
-    strncpy(player->username, username, sizeof(player->username) - 1);
-    player->protocol_state = 3;  /* Play state */
-    player->ready = true;
-    
-    printf("[PROTOCOL] Login Start: %s\n", username);
+    /* Включаем сжатие до Login Success */
+    if (COMPRESSION_THRESHOLD >= 0) {
+        packet_send_set_compression(player, COMPRESSION_THRESHOLD);
+    }
     
     /* Отправляем успех логина */
     packet_send_login_success(player);
@@ -489,42 +731,495 @@ void protocol_login_start(Player* player, PacketBuffer* buf) {
     
     /* Загружаем чанки вокруг игрока */
     player_load_chunks_around(player);
-    player_update_visible_entities(player);
-    
-    free(username);
 }
 
-void protocol_play_position_and_rotation(Player* player, PacketBuffer* buf) {
-    if (!player || !buf) return;
+void protocol_play_position_and_rotation(Player* player, PacketReader* r) {
+    if (!player || !r) return;
     
-    double x = buffer_read_double(buf);
-    double y = buffer_read_double(buf);
-    double z = buffer_read_double(buf);
-    float yaw = buffer_read_float(buf);
-    float pitch = buffer_read_float(buf);
-    uint8_t on_ground = buffer_read_byte(buf);
+    double x = reader_double(r);
+    double y = reader_double(r);
+    double z = reader_double(r);
+    float yaw = reader_float(r);
+    float pitch = reader_float(r);
+    uint8_t on_ground = reader_byte(r);
+    if (r->error) return;
     
     player_set_position(player, x, y, z, yaw, pitch);
-    player->on_ground = on_ground != 0;
+    server_state.hot.on_ground[player_slot(player)] = on_ground != 0;
+}
+
+void protocol_play_keep_alive(Player* player, PacketReader* r) {
+    if (!player || !r) return;
+    
+    int64_t keep_alive_id = reader_long(r);
+    if (r->error) return;
+    
+    player_keep_alive_response(player, keep_alive_id);
 }
 
-void protocol_play_block_place(Player* player, PacketBuffer* buf) {
-    if (!player || !buf) return;
+void protocol_play_block_place(Player* player, PacketReader* r) {
+    if (!player || !r) return;
     
     /* Упрощённо - не реализуем полностью */
     printf("[PROTOCOL] Block Place от %s\n", player->username);
 }
 
-void protocol_play_block_dig(Player* player, PacketBuffer* buf) {
-    if (!player || !buf) return;
+void protocol_play_block_dig(Player* player, PacketReader* r) {
+    if (!player || !r) return;
     
-    uint8_t status = buffer_read_byte(buf);
-    int32_t x = buffer_read_int(buf);
-    uint8_t y = buffer_read_byte(buf);
-    int32_t z = buffer_read_int(buf);
+    uint8_t status = reader_byte(r);
+    int32_t x = reader_int(r);
+    uint8_t y = reader_byte(r);
+    int32_t z = reader_int(r);
+    if (r->error) return;
     
     if (status == 2) {  /* Destroy block */
         block_set(x, y, z, 0);  /* Удаляем блок */
         printf("[PROTOCOL] Block Dig: %d,%d,%d удалён\n", x, y, z);
     }
 }
+
+/* === СТАТУС СЕРВЕРА === */
+
+/* Готовые ответы списку серверов. Пинги идут тысячами в минуту - JSON
+   собирается не чаще STATUS_CACHE_INTERVAL, дальше раздаётся ссылка на кадр */
+static pthread_mutex_t status_lock = PTHREAD_MUTEX_INITIALIZER;
+static Frame* status_frame = NULL;  /* Status Response (0x00) */
+static Frame* legacy_frame = NULL;  /* ответ на 0xFE */
+static uint64_t status_built_at = 0;
+
+/* Строка для JSON: кавычки, обратная косая черта и управляющие символы */
+static void json_escape(char* out, size_t cap, const char* str) {
+    size_t len = 0;
+    
+    for (; *str && len + 7 < cap; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            out[len++] = '\\';
+            out[len++] = (char)c;
+        } else if (c == '\n') {
+            out[len++] = '\\';
+            out[len++] = 'n';
+        } else if (c < 0x20) {
+            len += (size_t)snprintf(out + len, cap - len, "\\u%04x", c);
+        } else {
+            out[len++] = (char)c;
+        }
+    }
+    
+    out[len] = '\0';
+}
+
+/* UTF-8 -> UTF-16BE (только BMP). Возвращает число символов */
+static size_t utf16_put(uint8_t* out, const char* str, size_t len) {
+    size_t count = 0;
+    
+    for (size_t i = 0; i < len; count++) {
+        unsigned char c = (unsigned char)str[i];
+        uint16_t code;
+        
+        if (c < 0x80) {
+            code = c;
+            i += 1;
+        } else if ((c & 0xE0) == 0xC0 && i + 1 < len) {
+            code = (uint16_t)(((c & 0x1F) << 6) | (str[i + 1] & 0x3F));
+            i += 2;
+        } else if ((c & 0xF0) == 0xE0 && i + 2 < len) {
+            code = (uint16_t)(((c & 0x0F) << 12) | ((str[i + 1] & 0x3F) << 6) |
+                              (str[i + 2] & 0x3F));
+            i += 3;
+        } else {
+            code = '?';
+            i += 1;
+        }
+        
+        out[count * 2] = (uint8_t)(code >> 8);
+        out[count * 2 + 1] = (uint8_t)code;
+    }
+    
+    return count;
+}
+
+static Frame* status_build_response(int online) {
+    char motd[256];
+    json_escape(motd, sizeof(motd), MOTD);
+    
+    char json[512];
+    snprintf(json, sizeof(json),
+             "{\"version\":{\"name\":\"%s\",\"protocol\":%d},"
+             "\"players\":{\"max\":%d,\"online\":%d},"
+             "\"description\":{\"text\":\"%s\"}}",
+             PROTOCOL_VERSION_NAME, PROTOCOL_VERSION, MAX_PLAYERS, online, motd);
+    
+    PacketBuffer* payload = packet_create(strlen(json) + 8);
+    if (!payload) return NULL;
+    
+    buffer_write_string(payload, json);
+    Frame* frame = packet_build_frame(payload, 0x00, false);  /* Status Response */
+    buffer_free(payload);
+    return frame;
+}
+
+/* Kick-пакет 0xFF: "§1", протокол, версия, MOTD, онлайн, максимум через '\0' */
+static Frame* status_build_legacy(int online) {
+    char motd[128];
+    strncpy(motd, MOTD, sizeof(motd) - 1);
+    motd[sizeof(motd) - 1] = '\0';
+    
+    /* Старые клиенты показывают MOTD одной строкой */
+    for (char* c = motd; *c; c++) {
+        if (*c == '\n') *c = ' ';
+    }
+    
+    char text[256];
+    int len = snprintf(text, sizeof(text), "§1%c%d%c%s%c%s%c%d%c%d",
+                       0, PROTOCOL_VERSION, 0, PROTOCOL_VERSION_NAME, 0, motd,
+                       0, online, 0, MAX_PLAYERS);
+    if (len < 0 || (size_t)len >= sizeof(text)) return NULL;
+    
+    Frame* frame = frame_alloc(3 + (size_t)len * 2);
+    if (!frame) return NULL;
+    
+    size_t chars = utf16_put(frame->buf + 3, text, (size_t)len);
+    frame->buf[0] = 0xFF;
+    frame->buf[1] = (uint8_t)(chars >> 8);
+    frame->buf[2] = (uint8_t)chars;
+    frame->len = 3 + chars * 2;
+    frame_set_ready(frame);
+    return frame;
+}
+
+/* Ссылка на актуальный ответ (пересборка не чаще STATUS_CACHE_INTERVAL) */
+static Frame* status_acquire(bool legacy) {
+    pthread_mutex_lock(&status_lock);
+    
+    uint64_t now = get_millis();
+    if (!status_frame || now - status_built_at >= STATUS_CACHE_INTERVAL) {
+        int online = server_state.active_players;
+        Frame* response = status_build_response(online);
+        Frame* legacy_response = status_build_legacy(online);
+        
+        if (response && legacy_response) {
+            frame_release(status_frame);
+            frame_release(legacy_frame);
+            status_frame = response;
+            legacy_frame = legacy_response;
+            status_built_at = now;
+        } else {
+            /* Нет памяти - отдаём прежний ответ */
+            frame_release(response);
+            frame_release(legacy_response);
+        }
+    }
+    
+    Frame* frame = legacy ? legacy_frame : status_frame;
+    if (frame) frame_retain(frame);
+    
+    pthread_mutex_unlock(&status_lock);
+    return frame;
+}
+
+void protocol_status_free() {
+    pthread_mutex_lock(&status_lock);
+    frame_release(status_frame);
+    frame_release(legacy_frame);
+    status_frame = NULL;
+    legacy_frame = NULL;
+    pthread_mutex_unlock(&status_lock);
+}
+
+void protocol_handshake(Connection* conn, PacketReader* r) {
+    if (!conn || !r) return;
+    
+    int32_t protocol_version = reader_varint(r);
+    StringView server_address = reader_string(r, 255);
+    int16_t server_port = reader_short(r);
+    int32_t next_state = reader_varint(r);
+    if (r->error) return;
+    
+    /* 3 = transfer, для нас эквивалентен логину */
+    if (next_state == 3) next_state = PROTOCOL_STATE_LOGIN;
+    if (next_state != PROTOCOL_STATE_STATUS && next_state != PROTOCOL_STATE_LOGIN) {
+        next_state = PROTOCOL_STATE_COUNT;  /* следующий пакет разорвёт соединение */
+    }
+    
+    /* Пинги списка серверов не логируем - их слишком много */
+    if (next_state != PROTOCOL_STATE_STATUS || DEBUG_LOG) {
+        printf("[PROTOCOL] Handshake: version=%d, state=%d\n", protocol_version, next_state);
+    }
+    
+    conn->state = (uint8_t)next_state;
+    (void)server_address;
+    (void)server_port;
+}
+
+static void protocol_status_request(Connection* conn, PacketReader* r) {
+    (void)r;
+    
+    Frame* frame = status_acquire(false);
+    if (!frame) {
+        network_close(conn);
+        return;
+    }
+    
+    network_queue_frame(conn, frame);
+    frame_release(frame);
+    network_flush(conn);
+}
+
+static void protocol_status_ping(Connection* conn, PacketReader* r) {
+    int64_t payload_value = reader_long(r);
+    if (r->error) return;
+    
+    PacketBuffer* payload = packet_create(8);
+    if (payload) {
+        buffer_write_long(payload, payload_value);
+        size_t len = packet_finish(payload, 0x01);  /* Pong Response */
+        network_queue(conn, payload->data + payload->head, len);
+        buffer_free(payload);
+        network_flush(conn);
+    }
+    
+    /* Pong - последний пакет статуса */
+    network_close(conn);
+}
+
+void protocol_send_legacy_status(Connection* conn) {
+    if (!conn) return;
+    
+    Frame* frame = status_acquire(true);
+    if (frame) {
+        network_queue_frame(conn, frame);
+        frame_release(frame);
+        network_flush(conn);
+    }
+    
+    network_close(conn);
+}
+
+/* === ДИСПЕТЧЕРИЗАЦИЯ === */
+
+typedef void (*ConnectionHandler)(Connection* conn, PacketReader* r);
+
+/* До логина пакетов всего три - неизвестные закрывают соединение */
+static const ConnectionHandler connection_handlers[PROTOCOL_STATE_LOGIN][2] = {
+    [PROTOCOL_STATE_HANDSHAKE] = {
+        [0x00] = protocol_handshake,
+    },
+    [PROTOCOL_STATE_STATUS] = {
+        [0x00] = protocol_status_request,
+        [0x01] = protocol_status_ping,
+    },
+};
+
+bool protocol_handle_connection_packet(Connection* conn, PacketReader* frame) {
+    if (!conn || !frame) return false;
+    
+    int32_t packet_id = reader_varint(frame);
+    uint8_t state = conn->state;
+    
+    if (frame->error || state >= PROTOCOL_STATE_LOGIN || packet_id < 0 || packet_id >= 2) {
+        return false;
+    }
+    
+    ConnectionHandler handler = connection_handlers[state][packet_id];
+    if (!handler) return false;
+    
+    handler(conn, frame);
+    return !frame->error;
+}
+
+bool protocol_login_start_valid(const PacketReader* frame) {
+    if (!frame) return false;
+    
+    PacketReader r = *frame;
+    if (reader_varint(&r) != 0x00) return false;
+    
+    reader_string(&r, 16);
+    return !r.error;
+}
+
+typedef void (*PacketHandler)(Player* player, PacketReader* r);
+
+/* Обработчики по (состояние, ID пакета) */
+static const PacketHandler packet_handlers[PROTOCOL_STATE_COUNT][PROTOCOL_MAX_PACKET_ID] = {
+    [PROTOCOL_STATE_LOGIN] = {
+        [0x00] = protocol_login_start,
+    },
+    [PROTOCOL_STATE_PLAY] = {
+        [0x1B] = protocol_play_keep_alive,
+        [0x1E] = protocol_play_position_and_rotation,
+        [0x28] = protocol_play_block_dig,
+        [0x3F] = protocol_play_block_place,
+    },
+};
+
+/* Обработать один пакет (frame = ID + данные, без длины).
+   false - нарушение протокола, соединение нужно закрыть */
+bool protocol_handle_packet(Player* player, PacketReader* frame) {
+    if (!player || !frame) return false;
+    
+    int32_t packet_id = reader_varint(frame);
+    uint8_t state = player->protocol_state;
+    
+    if (frame->error || state >= PROTOCOL_STATE_COUNT ||
+        packet_id < 0 || packet_id >= PROTOCOL_MAX_PACKET_ID) {
+        return false;
+    }
+    
+    PacketHandler handler = packet_handlers[state][packet_id];
+    if (!handler) {
+        /* Неизвестные пакеты пропускаем */
+        if (DEBUG_LOG) {
+            printf("[NET] Пропущен пакет 0x%02X (state=%u)\n", packet_id, state);
+        }
+        return true;
+    }
+    
+    handler(player, frame);
+    return !frame->error;
+}
+
+/* === РАССЫЛКА === */
+
+static void broadcast_init(BroadcastPacket* bp, int32_t packet_id, uint64_t key,
+                           PacketBuffer* payload) {
+    bp->packet_id = packet_id;
+    bp->key = key;
+    bp->payload = payload;
+    bp->frames[0] = NULL;
+    bp->frames[1] = NULL;
+    bp->snapshot_id = 0;
+    bp->snapshot = NULL;
+    bp->snapshot_frames[0] = NULL;
+    bp->snapshot_frames[1] = NULL;
+}
+
+void broadcast_entity_movement(BroadcastPacket* bp, int32_t entity_id,
+                               const EntityPose* from, const EntityPose* to) {
+    uint64_t key = NET_KEY_ENTITY_MOVE | (uint32_t)entity_id;
+    
+    /* Абсолютный снимок: запасной вариант для медленных клиентов */
+    PacketBuffer* teleport = packet_create(48);
+    write_entity_teleport(teleport, entity_id, to);
+    
+    PacketBuffer* payload = packet_create(32);
+    int32_t packet_id = write_entity_move_relative(payload, entity_id, from, to);
+    
+    if (packet_id == 0) {
+        /* Сдвиг больше 8 блоков - только телепорт */
+        buffer_free(payload);
+        broadcast_init(bp, 0x62, key, teleport);  /* Entity Teleport */
+        return;
+    }
+    
+    broadcast_init(bp, packet_id, key, payload);
+    bp->snapshot_id = 0x62;  /* Entity Teleport */
+    bp->snapshot = teleport;
+}
+
+void broadcast_entity_teleport(BroadcastPacket* bp, int32_t entity_id, const EntityPose* to) {
+    PacketBuffer* payload = packet_create(48);
+    write_entity_teleport(payload, entity_id, to);
+    broadcast_init(bp, 0x62, NET_KEY_ENTITY_MOVE | (uint32_t)entity_id,
+                   payload);  /* Entity Teleport */
+}
+
+void broadcast_entity_destroy(BroadcastPacket* bp, int32_t entity_id) {
+    PacketBuffer* payload = packet_create(16);
+    write_entity_destroy(payload, &entity_id, 1);
+    broadcast_init(bp, 0x3A, 0, payload);  /* Destroy Entities */
+}
+
+void broadcast_block_change(BroadcastPacket* bp, int32_t x, int32_t y, int32_t z,
+                            uint8_t block_id) {
+    PacketBuffer* payload = packet_create(32);
+    write_block_change(payload, x, y, z, block_id);
+    
+    /* Позиция в 56 битах ключа: x, z по 22 бита, y - 12 */
+    uint64_t position = ((uint64_t)(x & 0x3FFFFF) << 34) |
+                        ((uint64_t)(z & 0x3FFFFF) << 12) |
+                        (uint64_t)(y & 0xFFF);
+    broadcast_init(bp, 0x09, NET_KEY_BLOCK | position, payload);  /* Block Change */
+}
+
+void broadcast_section_blocks(BroadcastPacket* bp, const BlockUpdate* updates, int count) {
+    PacketBuffer* payload = packet_create(16 + (size_t)count * VARLONG_MAX_BYTES);
+    
+    /* Позиция секции: x, z по 22 бита, y - 20 */
+    int32_t section_x = updates[0].x >> 4;
+    int32_t section_y = updates[0].y >> 4;
+    int32_t section_z = updates[0].z >> 4;
+    buffer_write_long(payload, (int64_t)(((uint64_t)(section_x & 0x3FFFFF) << 42) |
+                                         ((uint64_t)(section_z & 0x3FFFFF) << 20) |
+                                         (uint64_t)(section_y & 0xFFFFF)));
+    
+    /* Блок: состояние << 12 | x << 8 | z << 4 | y внутри секции */
+    buffer_write_varint(payload, count);
+    for (int i = 0; i < count; i++) {
+        const BlockUpdate* update = &updates[i];
+        buffer_write_varlong(payload, ((int64_t)update->block_id << 12) |
+                                      ((update->x & 15) << 8) |
+                                      ((update->z & 15) << 4) |
+                                      (update->y & 15));
+    }
+    
+    /* Дельта: медленному клиенту доходит целиком, не схлопывается */
+    broadcast_init(bp, 0x49, 0, payload);  /* Update Section Blocks */
+}
+
+/* Кадр формата собирается при первом получателе. Заголовки пишутся
+   только в резерв перед данными - сами данные остаются нетронутыми */
+static Frame* broadcast_frame(PacketBuffer* payload, int32_t packet_id, Frame** frames,
+                              bool compression) {
+    int format = compression ? 1 : 0;
+    
+    if (!frames[format]) {
+        payload->head = PACKET_HEADROOM;
+        frames[format] = packet_build_frame(payload, packet_id, compression);
+    }
+    return frames[format];
+}
+
+static bool frame_coalescable(Frame* frame) {
+    return frame && frame_is_ready(frame) && frame->len <= NET_COALESCE_MAX_PACKET;
+}
+
+void broadcast_send(BroadcastPacket* bp, Player* target) {
+    if (!bp->payload || !target || target->socket <= 0) return;
+    
+    Frame* frame = broadcast_frame(bp->payload, bp->packet_id, bp->frames, target->compression);
+    if (!frame) return;
+    
+    if (!bp->key || !frame_coalescable(frame)) {
+        network_queue_frame(target->conn, frame);
+        return;
+    }
+    
+    /* Снимок состояния может вытеснить предыдущий в очереди медленного клиента */
+    if (!bp->snapshot) {
+        network_queue_keyed(target->conn, bp->key, frame->data, frame->len);
+        return;
+    }
+    
+    /* Дельту медленному клиенту заменяет абсолютный снимок */
+    if (network_queue_delta(target->conn, bp->key, frame->data, frame->len)) return;
+    
+    Frame* snapshot = broadcast_frame(bp->snapshot, bp->snapshot_id, bp->snapshot_frames,
+                                      target->compression);
+    if (snapshot && frame_is_ready(snapshot)) {
+        network_queue_keyed(target->conn, bp->key, snapshot->data, snapshot->len);
+    }
+}
+
+void broadcast_free(BroadcastPacket* bp) {
+    frame_release(bp->frames[0]);
+    frame_release(bp->frames[1]);
+    buffer_free(bp->payload);
+    bp->payload = NULL;
+    
+    frame_release(bp->snapshot_frames[0]);
+    frame_release(bp->snapshot_frames[1]);
+    buffer_free(bp->snapshot);
+    bp->snapshot = NULL;
+}
@@ -4,8 +4,11 @@
 #include <time.h>
 #include <pthread.h>
 #include <dirent.h>
+#include <unistd.h>
 #include "server.h"
 #include "protocol.h"
+#include "grid.h"
+#include "tracker.h"
 
 /* === ФУНКЦИИ СЕРВЕРА === */
 
@@ -38,7 +41,11 @@ void server_print_stats() {
     printf("║ Тиков: %u\n", server_state.current_tick);
     printf("║ Активных игроков: %d / %d\n", server_state.active_players, MAX_PLAYERS);
     printf("║ Загруженных чанков: %d / %d\n", server_state.loaded_chunks, MAX_CHUNKS_LOADED);
-    printf("║ Тиков с лагом: %d\n", server_state.ticks_with_lag);
+    printf("║ TPS: %.1f | MSPT: %.1f (макс %.1f)\n",
+           server_state.tps, server_state.mspt, server_state.mspt_max);
+    printf("║ Тиков дольше %d мс: %llu, пропущено: %llu\n", TIME_BETWEEN_TICKS,
+           (unsigned long long)server_state.ticks_overrun,
+           (unsigned long long)server_state.ticks_skipped);
     printf("╚════════════════════════════════════════╝\n");
 }
 
@@ -48,8 +55,8 @@ void broadcast_chat_message(const char* username, const char* message) {
     
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
+    for (int i = 0; i < server_state.active_players; i++) {
+        if (player_ready(active_player(i))) {
             printf("[CHAT] %s\n", formatted);
         }
     }
@@ -64,10 +71,11 @@ void get_online_players(Player** out_players, int* out_count) {
     
     pthread_rwlock_rdlock(&server_state.players_lock);
     
-    for (int i = 0; i < MAX_PLAYERS && *out_count < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* player = active_player(i);
+        if (player->socket > 0 && player_ready(player)) {
             if (out_players) {
-                out_players[*out_count] = &server_state.players[i];
+                out_players[*out_count] = player;
             }
             (*out_count)++;
         }
@@ -76,6 +84,35 @@ void get_online_players(Player** out_players, int* out_count) {
     pthread_rwlock_unlock(&server_state.players_lock);
 }
 
+/* === ИНДЕКС ЗАНЯТЫХ СЛОТОВ === */
+
+/* Слот в списке, если его позиция указывает обратно на него -
+   начальные значения active_index не важны */
+static bool players_index_contains(int slot) {
+    int index = server_state.active_index[slot];
+    return index >= 0 && index < server_state.active_players &&
+           server_state.active_slots[index] == slot;
+}
+
+void players_index_add(Player* player) {
+    int slot = player_slot(player);
+    if (players_index_contains(slot)) return;
+    
+    server_state.active_index[slot] = server_state.active_players;
+    server_state.active_slots[server_state.active_players++] = slot;
+}
+
+void players_index_remove(Player* player) {
+    int slot = player_slot(player);
+    if (!players_index_contains(slot)) return;
+    
+    /* На место удалённого встаёт последний */
+    int index = server_state.active_index[slot];
+    int last = server_state.active_slots[--server_state.active_players];
+    server_state.active_slots[index] = last;
+    server_state.active_index[last] = index;
+}
+
 /* Удалить игрока из сервера */
 void remove_player(Player* player) {
     if (!player) return;
@@ -88,24 +125,34 @@ void remove_player(Player* player) {
         close(player->socket);
         player->socket = 0;
     }
+    player->conn = NULL;
+    server_state.hot.ready[player_slot(player)] = false;
+    grid_remove(player);
+    players_index_remove(player);
+    tracker_clear(player);
     
-    server_state.active_players--;
+    /* Удаляем игрока у тех, у кого он был заспавнен */
+    BroadcastPacket destroy;
+    broadcast_entity_destroy(&destroy, player->entity_id);
     
-    /* Уведомляем остальных игроков об удалении */
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (server_state.players[i].socket > 0 && server_state.players[i].ready) {
-            packet_send_entity_destroy(&server_state.players[i], player->entity_id);
+    for (int i = 0; i < server_state.active_players; i++) {
+        Player* viewer = active_player(i);
+        if (tracker_untrack(viewer, player) && viewer->socket > 0) {
+            broadcast_send(&destroy, viewer);
         }
     }
     
     pthread_rwlock_unlock(&server_state.players_lock);
+    
+    broadcast_free(&destroy);
 }
 
 /* Телепортировать игрока */
 void teleport_player(Player* player, double x, double y, double z) {
     if (!player) return;
     
-    player_set_position(player, x, y, z, player->yaw, player->pitch);
+    int slot = player_slot(player);
+    player_set_position(player, x, y, z, server_state.hot.yaw[slot], server_state.hot.pitch[slot]);
     
     /* Отправляем новую позицию клиенту */
     packet_send_player_position_and_look(player);
@@ -138,6 +185,9 @@ void set_player_health(Player* player, int32_t health) {
 void get_player_info(Player* player, char* out_buffer, size_t buffer_size) {
     if (!player || !out_buffer) return;
     
+    const PlayerHot* hot = &server_state.hot;
+    int slot = player_slot(player);
+    
     snprintf(out_buffer, buffer_size,
              "Игрок: %s\n"
              "  Position: (%.2f, %.2f, %.2f)\n"
@@ -146,11 +196,11 @@ void get_player_info(Player* player, char* out_buffer, size_t buffer_size) {
              "  Level: %d\n"
              "  Yaw: %.1f°, Pitch: %.1f°\n",
              player->username,
-             player->x, player->y, player->z,
+             hot->x[slot], hot->y[slot], hot->z[slot],
              player->health,
              player->experience,
              player->level,
-             player->yaw, player->pitch);
+             hot->yaw[slot], hot->pitch[slot]);
 }
 
 /* === ИНИЦИАЛИЗАЦИЯ СОХРАНЁННОГО МИРА === */
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include "tick.h"
+#include "server.h"
+
+#define NS_PER_MS  1000000ULL
+#define NS_PER_SEC 1000000000ULL
+#define TICK_INTERVAL_NS ((uint64_t)TIME_BETWEEN_TICKS * NS_PER_MS)
+
+static uint64_t deadline;     /* плановое начало текущего тика, нс */
+static uint64_t tick_start;   /* фактическое начало текущего тика */
+
+/* Окно статистики */
+static uint64_t window_start;
+static uint32_t window_ticks;
+static uint64_t window_busy;
+static uint64_t window_max;
+
+static uint64_t last_warning;  /* предупреждения об отставании - не чаще окна */
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t when) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(when / NS_PER_SEC),
+        .tv_nsec = (long)(when % NS_PER_SEC)
+    };
+
+    /* EINTR - досыпаем до того же дедлайна */
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+void tick_scheduler_init() {
+    uint64_t now = monotonic_ns();
+    deadline = now;
+    tick_start = now;
+    window_start = now;
+    window_ticks = 0;
+    window_busy = 0;
+    window_max = 0;
+    last_warning = 0;
+
+    server_state.tps = TICK_RATE;
+    server_state.mspt = 0.0f;
+    server_state.mspt_max = 0.0f;
+    server_state.ticks_overrun = 0;
+    server_state.ticks_skipped = 0;
+}
+
+void tick_begin() {
+    tick_start = monotonic_ns();
+}
+
+/* TPS - число тиков за окно по часам, MSPT - время работы без сна */
+static void stats_account(uint64_t now, uint64_t busy) {
+    window_ticks++;
+    window_busy += busy;
+    if (busy > window_max) window_max = busy;
+    if (busy > TICK_INTERVAL_NS) server_state.ticks_overrun++;
+
+    uint64_t elapsed = now - window_start;
+    if (elapsed < (uint64_t)TICK_STATS_WINDOW * NS_PER_MS) return;
+
+    server_state.tps = (float)((double)window_ticks * NS_PER_SEC / (double)elapsed);
+    server_state.mspt = (float)((double)window_busy / window_ticks / NS_PER_MS);
+    server_state.mspt_max = (float)((double)window_max / NS_PER_MS);
+
+    window_start = now;
+    window_ticks = 0;
+    window_busy = 0;
+    window_max = 0;
+}
+
+void tick_end() {
+    uint64_t now = monotonic_ns();
+    stats_account(now, now - tick_start);
+
+    uint64_t next = deadline + TICK_INTERVAL_NS;
+    if (now < next) {
+        deadline = next;
+        sleep_until(next);
+        return;
+    }
+
+    /* Отстаём: следующий тик начинается сразу */
+    uint64_t behind = (now - next) / TICK_INTERVAL_NS;
+
+#if TICK_CATCHUP_POLICY == TICK_CATCHUP_BURST
+    if (behind < TICK_CATCHUP_MAX) {
+        deadline = next;  /* долг остаётся, тики идут подряд до выравнивания */
+        return;
+    }
+#endif
+
+    server_state.ticks_skipped += behind;
+    if (behind > 0 && now - last_warning >= (uint64_t)TICK_STATS_WINDOW * NS_PER_MS) {
+        last_warning = now;
+        printf("[TICK] Не успеваем: пропущено тиков: %llu (%.1f мс)\n",
+               (unsigned long long)behind, (double)(now - next) / NS_PER_MS);
+    }
+    deadline = now;
+}
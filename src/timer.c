@@ -0,0 +1,111 @@
+#include <stddef.h>
+#include "timer.h"
+
+#define TIMER_MASK (TIMER_SLOTS - 1)
+
+static Timer* wheel[TIMER_LEVELS][TIMER_SLOTS];
+static uint64_t wheel_now = 0;
+
+static void list_add(Timer** head, Timer* timer) {
+    timer->next = *head;
+    if (timer->next) timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
+
+static void list_del(Timer* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next) timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/* Уровень - по расстоянию до срабатывания, слот - по абсолютному тику:
+   так слот старшего уровня раскладывается ровно в момент, когда
+   его таймеры попадают в окно младшего */
+static void wheel_insert(Timer* timer) {
+    uint64_t delta = timer->expires - wheel_now;
+    int level = 0;
+
+    while (level < TIMER_LEVELS - 1 && delta >> (TIMER_BITS * (level + 1))) {
+        level++;
+    }
+
+    size_t slot = (timer->expires >> (TIMER_BITS * level)) & TIMER_MASK;
+    list_add(&wheel[level][slot], timer);
+}
+
+/* Перенести слот уровня level на уровни ниже */
+static void wheel_cascade(int level, size_t slot) {
+    Timer* timer = wheel[level][slot];
+    wheel[level][slot] = NULL;
+
+    while (timer) {
+        Timer* next = timer->next;
+        wheel_insert(timer);
+        timer = next;
+    }
+}
+
+void timer_wheel_init(uint64_t now) {
+    for (int level = 0; level < TIMER_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_SLOTS; slot++) {
+            wheel[level][slot] = NULL;
+        }
+    }
+    wheel_now = now;
+}
+
+void timer_init(Timer* timer, TimerCallback callback, void* arg) {
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+}
+
+void timer_schedule(Timer* timer, uint64_t delay) {
+    if (timer_pending(timer)) list_del(timer);
+
+    if (delay < 1) delay = 1;
+    if (delay > TIMER_MAX_DELAY) delay = TIMER_MAX_DELAY;
+
+    timer->expires = wheel_now + delay;
+    wheel_insert(timer);
+}
+
+void timer_cancel(Timer* timer) {
+    if (timer_pending(timer)) list_del(timer);
+}
+
+uint64_t timer_now() {
+    return wheel_now;
+}
+
+void timer_advance(uint64_t now) {
+    while (wheel_now < now) {
+        wheel_now++;
+
+        /* Младшие биты обнулились - пора разложить слоты старших уровней */
+        for (int level = 1; level < TIMER_LEVELS; level++) {
+            if (wheel_now & ((1ULL << (TIMER_BITS * level)) - 1)) break;
+            wheel_cascade(level, (wheel_now >> (TIMER_BITS * level)) & TIMER_MASK);
+        }
+
+        /* Слот снимаем целиком: обработчики могут ставить таймеры заново,
+           а отмена ещё не вызванного таймера из этого списка остаётся корректной */
+        Timer* expired = NULL;
+        Timer** slot = &wheel[0][wheel_now & TIMER_MASK];
+        if (*slot) {
+            expired = *slot;
+            expired->pprev = &expired;
+            *slot = NULL;
+        }
+
+        while (expired) {
+            Timer* timer = expired;
+            list_del(timer);
+            timer->callback(timer->arg);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+#include <string.h>
+#include "tracker.h"
+#include "protocol.h"
+#include "grid.h"
+
+/* === ОТСЛЕЖИВАНИЕ СУЩНОСТЕЙ === */
+
+#define TRACK_WORDS ((MAX_PLAYERS + 63) / 64)
+
+/* Радиусы в ячейках сетки (чанках) для запросов окрестности */
+#define SPAWN_CELLS ((PLAYER_SPAWN_RADIUS + 15) / 16)
+
+#define SPAWN_RADIUS_SQ ((double)PLAYER_SPAWN_RADIUS * PLAYER_SPAWN_RADIUS)
+#define DESPAWN_RADIUS_SQ ((double)PLAYER_DESPAWN_RADIUS * PLAYER_DESPAWN_RADIUS)
+
+/* Внешние границы уровней (последний - до радиуса деспауна) и интервалы */
+static const double tier_radius[ENTITY_LOD_TIERS - 1] = {
+    ENTITY_LOD_NEAR_RADIUS, ENTITY_LOD_MID_RADIUS
+};
+static const uint32_t tier_interval[ENTITY_LOD_TIERS] = {
+    ENTITY_LOD_NEAR_INTERVAL, ENTITY_LOD_MID_INTERVAL, ENTITY_LOD_FAR_INTERVAL
+};
+
+/* tracked[зритель][уровень] - биты слотов, заспавненных у его клиента.
+   Каждый слот - не больше чем в одном уровне */
+static uint64_t tracked[MAX_PLAYERS][ENTITY_LOD_TIERS][TRACK_WORDS];
+
+/* sent_pose[сущность][уровень] - последнее разосланное положение */
+static EntityPose sent_pose[MAX_PLAYERS][ENTITY_LOD_TIERS];
+
+static inline double distance_sq(int a, int b) {
+    double dx = server_state.hot.x[a] - server_state.hot.x[b];
+    double dz = server_state.hot.z[a] - server_state.hot.z[b];
+    return dx * dx + dz * dz;
+}
+
+static inline double square(double value) {
+    return value * value;
+}
+
+/* Уровень по дистанции. Текущий (current >= 0) держится, пока граница
+   пересечена меньше чем на ENTITY_LOD_HYSTERESIS */
+static int tier_for(double dist_sq, int current) {
+    int tier = 0;
+    while (tier < ENTITY_LOD_TIERS - 1 && dist_sq > square(tier_radius[tier])) tier++;
+
+    if (current < 0 || tier == current) return tier;
+
+    if (tier > current &&
+        dist_sq <= square(tier_radius[current] + ENTITY_LOD_HYSTERESIS)) {
+        return current;
+    }
+    if (tier < current &&
+        dist_sq >= square(tier_radius[current - 1] - ENTITY_LOD_HYSTERESIS)) {
+        return current;
+    }
+    return tier;
+}
+
+void tracker_reset(Player* viewer) {
+    int slot = player_slot(viewer);
+    memset(tracked[slot], 0, sizeof(tracked[0]));
+
+    for (int tier = 0; tier < ENTITY_LOD_TIERS; tier++) {
+        entity_pose_of(&sent_pose[slot][tier], viewer);
+    }
+}
+
+void tracker_clear(Player* viewer) {
+    memset(tracked[player_slot(viewer)], 0, sizeof(tracked[0]));
+}
+
+EntityPose* tracker_sent_pose(const Player* entity, int tier) {
+    return &sent_pose[player_slot(entity)][tier];
+}
+
+bool tracker_tier_due(const Player* entity, int tier, uint32_t tick) {
+    return (tick + (uint32_t)player_slot(entity)) % tier_interval[tier] == 0;
+}
+
+int tracker_tier_cells(int tier) {
+    double radius = tier < ENTITY_LOD_TIERS - 1 ?
+                    tier_radius[tier] + ENTITY_LOD_HYSTERESIS : PLAYER_DESPAWN_RADIUS;
+    return ((int)radius + 15) / 16 + 1;
+}
+
+int tracker_tier(const Player* viewer, const Player* entity) {
+    int slot = player_slot(entity);
+    uint64_t bit = 1ULL << (slot & 63);
+
+    for (int tier = 0; tier < ENTITY_LOD_TIERS; tier++) {
+        if (tracked[player_slot(viewer)][tier][slot >> 6] & bit) return tier;
+    }
+    return -1;
+}
+
+bool tracker_untrack(Player* viewer, const Player* entity) {
+    int slot = player_slot(entity);
+    uint64_t bit = 1ULL << (slot & 63);
+    bool was = false;
+
+    for (int tier = 0; tier < ENTITY_LOD_TIERS; tier++) {
+        uint64_t* word = &tracked[player_slot(viewer)][tier][slot >> 6];
+        was |= (*word & bit) != 0;
+        *word &= ~bit;
+    }
+    return was;
+}
+
+/* Перевод на другой уровень: клиент знает положение старого уровня,
+   а дельты пойдут от положения нового - выравниваем телепортом */
+static void retier(Player* viewer, Player* entity, int from, int to) {
+    int slot = player_slot(entity);
+    uint64_t bit = 1ULL << (slot & 63);
+    uint64_t (*rows)[TRACK_WORDS] = tracked[player_slot(viewer)];
+
+    rows[from][slot >> 6] &= ~bit;
+    rows[to][slot >> 6] |= bit;
+
+    if (!entity_pose_equal(&sent_pose[slot][from], &sent_pose[slot][to])) {
+        BroadcastPacket teleport;
+        broadcast_entity_teleport(&teleport, entity->entity_id, &sent_pose[slot][to]);
+        broadcast_send(&teleport, viewer);
+        broadcast_free(&teleport);
+    }
+}
+
+static void track_enter(Player* entity, void* arg) {
+    Player* viewer = arg;
+    int slot = player_slot(entity);
+
+    if (entity == viewer || !server_state.hot.ready[slot]) return;
+    if (tracker_tier(viewer, entity) >= 0) return;
+
+    /* Ячейки покрывают квадрат - точный радиус проверяем здесь */
+    double dist_sq = distance_sq(player_slot(viewer), slot);
+    if (dist_sq > SPAWN_RADIUS_SQ) return;
+
+    int tier = tier_for(dist_sq, -1);
+
+    packet_send_entity_spawn(viewer, entity, &sent_pose[slot][tier]);
+    tracked[player_slot(viewer)][tier][slot >> 6] |= 1ULL << (slot & 63);
+}
+
+void tracker_update(Player* viewer) {
+    if (!viewer || !player_ready(viewer)) return;
+
+    int slot = player_slot(viewer);
+    uint64_t (*rows)[TRACK_WORDS] = tracked[slot];
+    int32_t leaving[MAX_PLAYERS];
+    int count = 0;
+
+    /* Уход и смена уровня: перебираем только заспавненных у этого клиента.
+       Читаются лишь горячие массивы - Player нужен только при смене уровня */
+    for (int tier = 0; tier < ENTITY_LOD_TIERS; tier++) {
+        for (int w = 0; w < TRACK_WORDS; w++) {
+            uint64_t bits = rows[tier][w];
+            while (bits) {
+                int bit = __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                int entity = w * 64 + bit;  /* = entity_id */
+                double dist_sq = distance_sq(slot, entity);
+
+                if (!server_state.hot.ready[entity] || dist_sq > DESPAWN_RADIUS_SQ) {
+                    rows[tier][w] &= ~(1ULL << bit);
+                    leaving[count++] = entity;
+                    continue;
+                }
+
+                /* Переведённый на дальний уровень встретится там ещё раз -
+                   по той же дистанции уровень уже не изменится */
+                int next = tier_for(dist_sq, tier);
+                if (next != tier) retier(viewer, &server_state.players[entity], tier, next);
+            }
+        }
+    }
+
+    if (count > 0) {
+        packet_send_entities_destroy(viewer, leaving, count);
+    }
+
+    /* Вход: кандидаты - из ячеек сетки в радиусе спауна */
+    grid_query(server_state.hot.x[slot], server_state.hot.z[slot], SPAWN_CELLS,
+               track_enter, viewer);
+}
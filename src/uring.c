@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "uring.h"
+
+/* === СИСТЕМНЫЕ ВЫЗОВЫ === */
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags, void* arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/* === КОЛЬЦА === */
+
+bool uring_init(Uring* ring, unsigned entries) {
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(Uring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = -1;
+
+    /* CQ вдвое больше SQ: multishot-операции дают много завершений */
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+
+    int fd = sys_io_uring_setup(entries, &params);
+    if (fd < 0) return false;
+    ring->fd = fd;
+
+    /* Нужны: одно mmap на оба кольца, без потерь CQE, таймаут в enter */
+    unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required) {
+        uring_exit(ring);
+        return false;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+
+    ring->sq_ring_ptr = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ptr == MAP_FAILED) {
+        ring->sq_ring_ptr = NULL;
+        uring_exit(ring);
+        return false;
+    }
+    ring->cq_ring_ptr = ring->sq_ring_ptr;
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        uring_exit(ring);
+        return false;
+    }
+
+    uint8_t* sq = ring->sq_ring_ptr;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_local_tail = *ring->sq_tail;
+
+    uint8_t* cq = ring->cq_ring_ptr;
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+void uring_exit(Uring* ring) {
+    if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+    if (ring->sq_ring_ptr) munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+    if (ring->fd >= 0) close(ring->fd);
+
+    ring->sqes = NULL;
+    ring->sq_ring_ptr = NULL;
+    ring->cq_ring_ptr = NULL;
+    ring->fd = -1;
+}
+
+bool uring_probe_op(Uring* ring, int op) {
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = calloc(1, size);
+    if (!probe) return false;
+
+    bool supported = false;
+    if (sys_io_uring_register(ring->fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+        op <= probe->last_op) {
+        supported = (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    free(probe);
+    return supported;
+}
+
+struct io_uring_sqe* uring_get_sqe(Uring* ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) return NULL;
+
+    unsigned index = ring->sq_local_tail & ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    ring->sq_array[index] = index;
+    ring->sq_local_tail++;
+
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int uring_submit_and_wait(Uring* ring, unsigned wait_nr, int timeout_ms) {
+    unsigned to_submit = ring->sq_local_tail - *ring->sq_tail;
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    void* argp = NULL;
+    size_t argsz = 0;
+
+    if (wait_nr > 0 && timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        argp = &arg;
+        argsz = sizeof(arg);
+        flags |= IORING_ENTER_EXT_ARG;
+    }
+
+    int ret = sys_io_uring_enter(ring->fd, to_submit, wait_nr, flags, argp, argsz);
+    if (ret < 0) {
+        /* Истёкший таймаут - штатная ситуация */
+        if (errno == ETIME || errno == EINTR) return 0;
+        return -errno;
+    }
+    return ret;
+}
+
+struct io_uring_cqe* uring_peek_cqe(Uring* ring) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return NULL;
+    return &ring->cqes[head & ring->cq_mask];
+}
+
+void uring_cqe_seen(Uring* ring) {
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+/* === КОЛЬЦО БУФЕРОВ === */
+
+bool uring_buf_ring_init(Uring* ring, UringBufRing* br, uint16_t group_id,
+                         unsigned entries, unsigned buf_size) {
+    memset(br, 0, sizeof(UringBufRing));
+
+    /* Размер кольца - степень двойки */
+    if (entries == 0 || (entries & (entries - 1)) != 0) return false;
+
+    br->ring_size = entries * sizeof(struct io_uring_buf);
+    br->ring = mmap(NULL, br->ring_size, PROT_READ | PROT_WRITE,
+                    MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (br->ring == MAP_FAILED) {
+        br->ring = NULL;
+        return false;
+    }
+
+    br->data = malloc((size_t)entries * buf_size);
+    if (!br->data) {
+        munmap(br->ring, br->ring_size);
+        br->ring = NULL;
+        return false;
+    }
+
+    br->entries = entries;
+    br->buf_size = buf_size;
+    br->group_id = group_id;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)br->ring;
+    reg.ring_entries = entries;
+    reg.bgid = group_id;
+
+    if (sys_io_uring_register(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        free(br->data);
+        munmap(br->ring, br->ring_size);
+        memset(br, 0, sizeof(UringBufRing));
+        return false;
+    }
+
+    for (unsigned i = 0; i < entries; i++) {
+        uring_buf_ring_recycle(br, (uint16_t)i);
+    }
+
+    return true;
+}
+
+void uring_buf_ring_free(Uring* ring, UringBufRing* br) {
+    if (!br->ring) return;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.bgid = br->group_id;
+    sys_io_uring_register(ring->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+
+    free(br->data);
+    munmap(br->ring, br->ring_size);
+    memset(br, 0, sizeof(UringBufRing));
+}
+
+uint8_t* uring_buf_ring_get(UringBufRing* br, uint16_t bid) {
+    return br->data + (size_t)bid * br->buf_size;
+}
+
+void uring_buf_ring_recycle(UringBufRing* br, uint16_t bid) {
+    /* Хвост кольца пишет только владелец кольца */
+    uint16_t tail = br->ring->tail;
+    struct io_uring_buf* buf = &br->ring->bufs[tail & (br->entries - 1)];
+
+    buf->addr = (uint64_t)(uintptr_t)uring_buf_ring_get(br, bid);
+    buf->len = br->buf_size;
+    buf->bid = bid;
+
+    __atomic_store_n(&br->ring->tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,296 @@
+#include <string.h>
+#include "varint.h"
+#include "utils.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Разбор словом: 8 байт читаются разом, порядок байт - little-endian */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VARINT_WORD 1
+#else
+#define VARINT_WORD 0
+#endif
+
+/* === РАЗМЕР === */
+
+/* Значащих бит b -> ceil(b / 7) байт; (b * 9 + 64) / 64 даёт то же без деления */
+int varint_size(uint32_t value) {
+    int bits = 32 - __builtin_clz(value | 1);
+    return (bits * 9 + 64) >> 6;
+}
+
+int varlong_size(uint64_t value) {
+    int bits = 64 - __builtin_clzll(value | 1);
+    return (bits * 9 + 64) >> 6;
+}
+
+/* === ОДИНОЧНЫЕ ЗНАЧЕНИЯ === */
+
+int varint_encode(uint8_t* out, uint32_t value) {
+    /* ID пакетов, длины, индексы палитры - почти всегда 1-2 байта */
+    if (LIKELY(value < 0x80)) {
+        out[0] = (uint8_t)value;
+        return 1;
+    }
+    if (value < 0x4000) {
+        out[0] = (uint8_t)(value | 0x80);
+        out[1] = (uint8_t)(value >> 7);
+        return 2;
+    }
+
+    int len = varint_size(value);
+
+#if VARINT_WORD
+    /* Раскладываем группы по 7 бит в байты слова и ставим биты продолжения */
+    uint64_t x = value;
+    uint64_t word = (x & 0x7F) |
+                    ((x & 0x3F80) << 1) |
+                    ((x & 0x1FC000) << 2) |
+                    ((x & 0xFE00000) << 3) |
+                    ((x & 0xF0000000ULL) << 4);
+    word |= 0x80808080ULL >> ((VARINT_MAX_BYTES - len) * 8);
+    memcpy(out, &word, (size_t)len);
+#else
+    for (int i = 0; i < len - 1; i++) {
+        out[i] = (uint8_t)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[len - 1] = (uint8_t)value;
+#endif
+
+    return len;
+}
+
+int varlong_encode(uint8_t* out, uint64_t value) {
+    int len = varlong_size(value);
+    for (int i = 0; i < len - 1; i++) {
+        out[i] = (uint8_t)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[len - 1] = (uint8_t)value;
+    return len;
+}
+
+int varint_decode(const uint8_t* in, size_t avail, uint32_t* out) {
+    /* 1-2 байта - подавляющее большинство */
+    if (LIKELY(avail >= 2)) {
+        if ((in[0] & 0x80) == 0) {
+            *out = in[0];
+            return 1;
+        }
+        if ((in[1] & 0x80) == 0) {
+            *out = (uint32_t)(in[0] & 0x7F) | ((uint32_t)in[1] << 7);
+            return 2;
+        }
+    }
+
+#if VARINT_WORD
+    if (LIKELY(avail >= 8)) {
+        uint64_t word;
+        memcpy(&word, in, 8);
+
+        /* Последний байт - первый без бита продолжения среди пяти */
+        uint64_t stops = ~word & 0x8080808080ULL;
+        if (UNLIKELY(stops == 0)) return -1;
+
+        int len = (__builtin_ctzll(stops) >> 3) + 1;
+        word &= 0x7F7F7F7F7FULL >> ((VARINT_MAX_BYTES - len) * 8);
+
+        uint64_t value = (word & 0x7F) |
+                         ((word >> 1) & 0x3F80) |
+                         ((word >> 2) & 0x1FC000) |
+                         ((word >> 3) & 0xFE00000) |
+                         ((word >> 4) & 0x7F0000000ULL);
+
+        /* В пятом байте значимы только 4 младших бита */
+        if (UNLIKELY(value >> 32)) return -1;
+
+        *out = (uint32_t)value;
+        return len;
+    }
+#endif
+
+    uint32_t value = 0;
+    for (int i = 0; i < VARINT_MAX_BYTES; i++) {
+        if ((size_t)i >= avail) return 0;
+
+        uint8_t byte = in[i];
+        if (i == VARINT_MAX_BYTES - 1 && byte > 0x0F) return -1;
+
+        value |= (uint32_t)(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            *out = value;
+            return i + 1;
+        }
+    }
+
+    return -1;
+}
+
+/* === МАССИВЫ === */
+
+/* Скалярный путь кодирования массивов без ветвления по длине для значений
+   до 2 байт (случайная смесь 1 и 2 байт иначе ломает предсказатель переходов).
+   Пишет 2 байта даже для однобайтового значения - место в массиве есть.
+   При декодировании так не выйти: позиция следующего значения зависит от
+   длины текущего, и предсказанный переход выгоднее цепочки зависимостей */
+static inline int encode_short(uint8_t* out, uint32_t value) {
+    if (LIKELY(value < 0x4000)) {
+        uint32_t big = value >= 0x80;
+        out[0] = (uint8_t)((value & 0x7F) | (big << 7));
+        out[1] = (uint8_t)(value >> 7);
+        return 1 + (int)big;
+    }
+    return varint_encode(out, value);
+}
+
+#if defined(__SSE2__)
+/* Все 4 значения без бит из mask */
+static inline int sse_fits(__m128i v, __m128i mask) {
+    __m128i zero = _mm_setzero_si128();
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, mask), zero)) == 0xFFFF;
+}
+
+#if defined(__SSSE3__)
+/* Сжатие 4 пар байт (по значению) в поток VarInt: у однобайтовых значений
+   второй байт пары выбрасывается. Индекс - маска двухбайтовых значений */
+typedef struct {
+    int8_t index[16];
+    int len;
+} VarintShuffle;
+
+static const VarintShuffle pair_shuffle[16] = {
+    { {0, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 4 },
+    { {0, 1, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 5 },
+    { {0, 2, 3, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 5 },
+    { {0, 1, 2, 3, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 2, 4, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 5 },
+    { {0, 1, 2, 4, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 2, 3, 4, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 1, 2, 3, 4, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 7 },
+    { {0, 2, 4, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 5 },
+    { {0, 1, 2, 4, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 2, 3, 4, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 1, 2, 3, 4, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 7 },
+    { {0, 2, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 6 },
+    { {0, 1, 2, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 7 },
+    { {0, 2, 3, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1}, 7 },
+    { {0, 1, 2, 3, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1}, 8 },
+};
+#endif
+
+/* 4 значения < 0x4000 -> VarInt. Число байт или -1 (есть значения длиннее) */
+static inline int sse_encode4(uint8_t* out, __m128i v) {
+    __m128i zero = _mm_setzero_si128();
+    if (!sse_fits(v, _mm_set1_epi32(~0x3FFF))) return -1;
+
+    /* Полосы с однобайтовыми значениями */
+    __m128i small = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(~0x7F)), zero);
+    int two = ~_mm_movemask_ps(_mm_castsi128_ps(small)) & 0xF;
+
+    if (two == 0) {
+        __m128i words = _mm_packs_epi32(v, v);
+        uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+        memcpy(out, &bytes, 4);
+        return 4;
+    }
+
+#if !defined(__SSSE3__)
+    /* Без pshufb смешанные длины не уплотнить */
+    if (two != 0xF) return -1;
+#endif
+
+    /* Пара байт VarInt в каждой полосе: младшие 7 бит | 0x80, остаток */
+    __m128i low = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0x7F)), _mm_set1_epi32(0x80));
+    __m128i pairs = _mm_or_si128(low, _mm_slli_epi32(_mm_srli_epi32(v, 7), 8));
+    __m128i words = _mm_or_si128(_mm_and_si128(small, v), _mm_andnot_si128(small, pairs));
+    __m128i packed = _mm_packs_epi32(words, words);
+
+#if defined(__SSSE3__)
+    const VarintShuffle* shuffle = &pair_shuffle[two];
+    __m128i index = _mm_loadu_si128((const __m128i*)shuffle->index);
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi8(packed, index));
+    return shuffle->len;
+#else
+    _mm_storel_epi64((__m128i*)out, packed);
+    return 8;
+#endif
+}
+#endif
+
+/* Столько блоков подряд не уложилось в SIMD - остаток массива идёт
+   скалярным циклом: в смеси с длинными значениями проверка блоков
+   только тратит время. Редкие длинные значения (состояния блоков)
+   серию промахов не набирают */
+#define SIMD_MISS_LIMIT 4
+
+/* values[i..end) полным кодеком, без второй проверки длины */
+static inline uint8_t* encode_scalar(uint8_t* out, const uint32_t* values,
+                                     size_t i, size_t end) {
+    for (; i < end; i++) out += varint_encode(out, values[i]);
+    return out;
+}
+
+size_t varint_encode_batch(uint8_t* out, const uint32_t* values, size_t count) {
+    uint8_t* start = out;
+    size_t i = 0;
+    int misses = 0;
+
+#if defined(__AVX2__)
+    const __m256i one_byte = _mm256_set1_epi32(~0x7F);
+
+    for (; i + 8 <= count && misses < SIMD_MISS_LIMIT; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+
+        if (_mm256_testz_si256(v, one_byte)) {
+            /* 8 значений по байту: сужаем 32 -> 16 -> 8 бит */
+            __m128i words = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(words, words));
+            out += 8;
+            misses = 0;
+            continue;
+        }
+
+        int len = sse_encode4(out, lo);
+        if (len < 0) {
+            out = encode_scalar(out, values, i, i + 4);
+            misses++;
+        } else {
+            out += len;
+            misses = 0;
+        }
+
+        len = sse_encode4(out, hi);
+        if (len < 0) {
+            out = encode_scalar(out, values, i + 4, i + 8);
+            misses++;
+        } else {
+            out += len;
+            misses = 0;
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; i + 4 <= count && misses < SIMD_MISS_LIMIT; i += 4) {
+        int len = sse_encode4(out, _mm_loadu_si128((const __m128i*)(values + i)));
+        if (len < 0) {
+            out = encode_scalar(out, values, i, i + 4);
+            misses++;
+        } else {
+            out += len;
+            misses = 0;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        out += encode_short(out, values[i]);
+    }
+
+    return (size_t)(out - start);
+}